@@ -4,6 +4,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <ctime>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,8 +12,26 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <climits>
 #include <cassert>
-#include <ilcplex/ilocplex.h>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#ifdef USE_CPLEX
+#include <ilcplex/cplex.h>
+#endif
+#ifdef USE_HIGHS
+#include "Highs.h"
+#endif
 using namespace std;
 
 typedef unsigned long long llu;
@@ -29,19 +48,208 @@ void printHeader(const char * text) {
 }
 
 // Global variables
-struct stringPairHash {
-	size_t operator() (const pair<string, string> & Q) const {
-		size_t h1 = hash<string>() (Q.first);
-		size_t h2 = hash<string>() (Q.second);
-		return h1 ^ (h2 << 1);
-	}
-};
-
 struct Entry {
 	string * names;
 	unordered_map<string, int> indices;
 } samples, genes, alterations;
 
+/*
+	Word-array kernels behind the Bitmask operations, selected once at start-up based on the instruction sets the CPU supports.
+	All variants produce identical results; in particular the hash is defined over 8 interleaved 64-bit lanes, so that the vector paths do not change it.
+*/
+struct BitmaskKernels {
+	const char * name;
+	int (*andCount)(llu * dst, const llu * src, int len);	// dst &= src, returns the number of set bits in dst
+	int (*orCount)(llu * dst, const llu * src, int len);	// dst |= src, returns the number of set bits in dst
+	int (*copyCount)(llu * dst, const llu * src, int len);	// dst = src, returns the number of set bits in dst
+	bool (*equal)(const llu * a, const llu * b, int len);
+	size_t (*hash)(const llu * a, int len);
+};
+
+const llu HASH_SEED		= 0x9E3779B97F4A7C15ULL;
+const llu HASH_FACTOR	= 0xFF51AFD7ED558CCDULL;
+
+inline size_t foldHashLanes(const llu * lanes, int len) {
+	llu res = len;
+	for (int lane = 0; lane < 8; lane++) {
+		res = (res ^ lanes[lane]) * HASH_FACTOR;
+		res ^= res >> 29;
+	}
+	return res;
+}
+
+int andCountScalar(llu * dst, const llu * src, int len) {
+	int size = 0;
+	for (int i = 0; i < len; i++) {
+		dst[i] &= src[i];
+		size += __builtin_popcountll(dst[i]);
+	}
+	return size;
+}
+
+int orCountScalar(llu * dst, const llu * src, int len) {
+	int size = 0;
+	for (int i = 0; i < len; i++) {
+		dst[i] |= src[i];
+		size += __builtin_popcountll(dst[i]);
+	}
+	return size;
+}
+
+int copyCountScalar(llu * dst, const llu * src, int len) {
+	int size = 0;
+	for (int i = 0; i < len; i++) {
+		dst[i] = src[i];
+		size += __builtin_popcountll(dst[i]);
+	}
+	return size;
+}
+
+bool equalScalar(const llu * a, const llu * b, int len) {
+	for (int i = 0; i < len; i++) if (a[i] != b[i]) return false;
+	return true;
+}
+
+size_t hashScalar(const llu * a, int len) {
+	llu lanes[8];
+	for (int lane = 0; lane < 8; lane++) lanes[lane] = HASH_SEED + lane;
+	for (int i = 0; i < len; i++)
+		lanes[i % 8] = (lanes[i % 8] ^ a[i]) * HASH_FACTOR;
+	return foldHashLanes(lanes, len);
+}
+
+#if defined(__x86_64__)
+// Per-64-bit-lane population count via nibble lookup
+__attribute__((target("avx2"))) inline __m256i popcount256(__m256i v) {
+	const __m256i lookup	= _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i lowMask	= _mm256_set1_epi8(0x0f);
+	__m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+	__m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+	return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2"))) inline int horizontalSum256(__m256i v) {
+	llu lanes[4];
+	_mm256_storeu_si256((__m256i *) lanes, v);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Lane-wise 64-bit multiplication, which AVX2 only has for 32-bit halves
+__attribute__((target("avx2"))) inline __m256i multiply256(__m256i a, __m256i b) {
+	__m256i lo		= _mm256_mul_epu32(a, b);
+	__m256i cross	= _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+	return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+#define AND_WORDS(a, b)		((a) & (b))
+#define OR_WORDS(a, b)		((a) | (b))
+#define COPY_WORDS(a, b)	(b)
+
+#define AVX2_COUNT_KERNEL(NAME, VECTOR_OP, WORD_OP) \
+__attribute__((target("avx2,popcnt"))) int NAME(llu * dst, const llu * src, int len) { \
+	__m256i counts = _mm256_setzero_si256(); \
+	int i = 0; \
+	for (; i + 4 <= len; i += 4) { \
+		__m256i v = VECTOR_OP(_mm256_loadu_si256((const __m256i *) (dst + i)), _mm256_loadu_si256((const __m256i *) (src + i))); \
+		_mm256_storeu_si256((__m256i *) (dst + i), v); \
+		counts = _mm256_add_epi64(counts, popcount256(v)); \
+	} \
+	int size = horizontalSum256(counts); \
+	for (; i < len; i++) { \
+		dst[i] = WORD_OP(dst[i], src[i]); \
+		size += __builtin_popcountll(dst[i]); \
+	} \
+	return size; \
+}
+
+AVX2_COUNT_KERNEL(andCountAVX2, _mm256_and_si256, AND_WORDS)
+AVX2_COUNT_KERNEL(orCountAVX2, _mm256_or_si256, OR_WORDS)
+AVX2_COUNT_KERNEL(copyCountAVX2, COPY_WORDS, COPY_WORDS)
+#undef AVX2_COUNT_KERNEL
+
+__attribute__((target("avx2"))) bool equalAVX2(const llu * a, const llu * b, int len) {
+	int i = 0;
+	for (; i + 4 <= len; i += 4) {
+		__m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *) (a + i)), _mm256_loadu_si256((const __m256i *) (b + i)));
+		if (!_mm256_testz_si256(diff, diff)) return false;
+	}
+	for (; i < len; i++) if (a[i] != b[i]) return false;
+	return true;
+}
+
+__attribute__((target("avx2"))) size_t hashAVX2(const llu * a, int len) {
+	const __m256i factor = _mm256_set1_epi64x(HASH_FACTOR);
+	__m256i lanesLo = _mm256_setr_epi64x(HASH_SEED, HASH_SEED + 1, HASH_SEED + 2, HASH_SEED + 3);
+	__m256i lanesHi = _mm256_setr_epi64x(HASH_SEED + 4, HASH_SEED + 5, HASH_SEED + 6, HASH_SEED + 7);
+	int i = 0;
+	for (; i + 8 <= len; i += 8) {
+		lanesLo = multiply256(_mm256_xor_si256(lanesLo, _mm256_loadu_si256((const __m256i *) (a + i))), factor);
+		lanesHi = multiply256(_mm256_xor_si256(lanesHi, _mm256_loadu_si256((const __m256i *) (a + i + 4))), factor);
+	}
+	llu lanes[8];
+	_mm256_storeu_si256((__m256i *) lanes, lanesLo);
+	_mm256_storeu_si256((__m256i *) (lanes + 4), lanesHi);
+	for (; i < len; i++)
+		lanes[i % 8] = (lanes[i % 8] ^ a[i]) * HASH_FACTOR;
+	return foldHashLanes(lanes, len);
+}
+
+#define AVX512_COUNT_KERNEL(NAME, OP) \
+__attribute__((target("avx512f,avx512vpopcntdq"))) int NAME(llu * dst, const llu * src, int len) { \
+	__m512i counts = _mm512_setzero_si512(); \
+	for (int i = 0; i < len; i += 8) { \
+		__mmask8 active = (len - i >= 8) ? 0xff : (__mmask8) ((1u << (len - i)) - 1); \
+		__m512i v = OP(_mm512_maskz_loadu_epi64(active, dst + i), _mm512_maskz_loadu_epi64(active, src + i)); \
+		_mm512_mask_storeu_epi64(dst + i, active, v); \
+		counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(v)); \
+	} \
+	return _mm512_reduce_add_epi64(counts); \
+}
+
+AVX512_COUNT_KERNEL(andCountAVX512, _mm512_and_si512)
+AVX512_COUNT_KERNEL(orCountAVX512, _mm512_or_si512)
+AVX512_COUNT_KERNEL(copyCountAVX512, COPY_WORDS)
+#undef AVX512_COUNT_KERNEL
+#undef AND_WORDS
+#undef OR_WORDS
+#undef COPY_WORDS
+
+__attribute__((target("avx512f"))) bool equalAVX512(const llu * a, const llu * b, int len) {
+	for (int i = 0; i < len; i += 8) {
+		__mmask8 active = (len - i >= 8) ? 0xff : (__mmask8) ((1u << (len - i)) - 1);
+		if (_mm512_mask_cmpneq_epi64_mask(active, _mm512_maskz_loadu_epi64(active, a + i), _mm512_maskz_loadu_epi64(active, b + i)))
+			return false;
+	}
+	return true;
+}
+
+__attribute__((target("avx512f,avx512dq"))) size_t hashAVX512(const llu * a, int len) {
+	const __m512i factor = _mm512_set1_epi64(HASH_FACTOR);
+	__m512i lanesV = _mm512_add_epi64(_mm512_set1_epi64(HASH_SEED), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+	for (int i = 0; i < len; i += 8) {
+		__mmask8 active = (len - i >= 8) ? 0xff : (__mmask8) ((1u << (len - i)) - 1);
+		__m512i updated = _mm512_mullo_epi64(_mm512_xor_si512(lanesV, _mm512_maskz_loadu_epi64(active, a + i)), factor);
+		lanesV = _mm512_mask_mov_epi64(lanesV, active, updated);
+	}
+	llu lanes[8];
+	_mm512_storeu_si512(lanes, lanesV);
+	return foldHashLanes(lanes, len);
+}
+#endif
+
+BitmaskKernels selectBitmaskKernels() {
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vpopcntdq"))
+		return { "AVX-512", andCountAVX512, orCountAVX512, copyCountAVX512, equalAVX512, hashAVX512 };
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+		return { "AVX2", andCountAVX2, orCountAVX2, copyCountAVX2, equalAVX2, hashAVX2 };
+#endif
+	return { "scalar", andCountScalar, orCountScalar, copyCountScalar, equalScalar, hashScalar };
+}
+
+BitmaskKernels bitmaskKernels = selectBitmaskKernels();
+
 struct Bitmask {
 	int maxSize;
 	int size;
@@ -73,13 +281,34 @@ struct Bitmask {
 			bits[i] = Q -> bits[i];
 	}
 
+	Bitmask(Bitmask && Q) noexcept : maxSize(Q.maxSize), size(Q.size), len(Q.len), bits(Q.bits) {
+		Q.bits = 0;
+	}
+
+	Bitmask & operator= (const Bitmask & Q) {
+		if (this != &Q) {
+			Bitmask copy(Q);
+			swap(*this, copy);
+		}
+		return *this;
+	}
+
+	Bitmask & operator= (Bitmask && Q) noexcept {
+		std::swap(maxSize, Q.maxSize);
+		std::swap(size, Q.size);
+		std::swap(len, Q.len);
+		std::swap(bits, Q.bits);
+		return *this;
+	}
+
 	~Bitmask() {
 		if (bits)
-			delete bits;
+			delete [] bits;
 	}
 
 	bool operator== (const Bitmask & Q) const {
 		if (size != Q.size) return false;
+		if (len == Q.len) return bitmaskKernels.equal(bits, Q.bits, len);
 		int minLen = (len < Q.len) ? len : Q.len;
 		for (int i = 0; i < minLen; i++) if (bits[i] != Q.bits[i]) return false;
 		for (int i = minLen; i < len; i++) if (bits[i]) return false;
@@ -120,6 +349,25 @@ struct Bitmask {
 
 	int getSize() const { return size; }
 
+	// Keeps only the bits that are also set in Q, an array of 'len' words. Returns true if the bitmask changes (shrinks).
+	bool intersectWith(const llu * Q) {
+		int oldSize = size;
+		size = bitmaskKernels.andCount(bits, Q, len);
+		return size != oldSize;
+	}
+
+	// Sets all bits that are set in Q, an array of 'len' words. Returns true if the bitmask changes (grows).
+	bool unionWith(const llu * Q) {
+		int oldSize = size;
+		size = bitmaskKernels.orCount(bits, Q, len);
+		return size != oldSize;
+	}
+
+	// Overwrites the bitmask with Q, an array of 'len' words.
+	void copyBits(const llu * Q) {
+		size = bitmaskKernels.copyCount(bits, Q, len);
+	}
+
 	void invert() {
 		for (int i = 0; i < len; i++)
 			bits[i] = ~bits[i];
@@ -150,75 +398,186 @@ struct Bitmask {
 	}
 };
 
-struct BitmaskHasher {
-	std::size_t operator()(const Bitmask & Q) const {
-		using std::size_t;
-		using std::hash;
-		size_t res = 17;
-		for (int i = 0; i < Q.len; i++) {
-			res = res * 31 + hash< unsigned long long >()(Q.bits[i]);
+/*
+	Sample bitmask with inline storage for cohorts of at most 64 * W samples. It has the same interface as Bitmask, but copying it never allocates.
+	runSolver picks the smallest width that fits the cohort, and falls back to Bitmask for larger cohorts.
+*/
+template <int W>
+struct FixedBitmask {
+	static const int len = W;
+	int maxSize;
+	int size;
+	llu bits[W];
+
+	FixedBitmask(int maxSize) : maxSize(maxSize) {
+		if (maxSize > 64 * W) {
+			fprintf(stderr, "< Error > Cannot construct a bitmask of %d bits with space for only %d bits.\n", maxSize, 64 * W);
+			exit(0);
 		}
-		return res;
+		size = 0;
+		memset(bits, 0, sizeof(bits));
 	}
-};
 
-struct SubnetworkEntry {
-	vector<int> nodes;
-	vector<int> nodeColourIdx;
-	Bitmask * samples;
-	int seedSampleIdx;
-	bool isValid;
+	bool operator== (const FixedBitmask & Q) const {
+		return size == Q.size && bitmaskKernels.equal(bits, Q.bits, W);
+	}
+
+	void setBit(int pos, bool val) {
+		int idx = pos / 64;
+		if (idx >= W) {
+			fprintf(stderr, "< Error > Cannot assign bit because bitmask is too small. pos: %d | len: %d | idx: %d | maxSize: %d\n", pos, W, idx, maxSize);
+			exit(0);
+		}
+		llu bit = llu(1) << (pos % 64);
+		if (bool(bits[idx] & bit) ^ val) {	// the bit is about to get changed
+			bits[idx] ^= bit;
+			if (val) size++;
+			else size--;
+		}
+	}
+
+	bool getBit(int pos) const {
+		int idx = pos / 64;
+		if (idx >= W) {
+			fprintf(stderr, "< Error > Cannot return bit because bitmask is too small.\n");
+			exit(0);
+		}
+		return bits[idx] & (llu(1) << (pos % 64));
+	}
+
+	int getSize() const { return size; }
 
-	SubnetworkEntry() : samples(0), isValid(true) {}
+	bool intersectWith(const llu * Q) {
+		int oldSize = size;
+		size = bitmaskKernels.andCount(bits, Q, W);
+		return size != oldSize;
+	}
+
+	bool unionWith(const llu * Q) {
+		int oldSize = size;
+		size = bitmaskKernels.orCount(bits, Q, W);
+		return size != oldSize;
+	}
 
-	SubnetworkEntry(int totalNumSamples) : isValid(true) {
-		samples = new Bitmask(totalNumSamples);
+	void copyBits(const llu * Q) {
+		size = bitmaskKernels.copyCount(bits, Q, W);
 	}
 
-	SubnetworkEntry(vector<int> & nodeV, int totalNumSamples) : isValid(true) {
-		nodes = nodeV;
-		samples = new Bitmask(totalNumSamples);
+	int extractLowestOrderSetBitIndex() {
+		for (int i = 0; i < W; i++) {
+			if (bits[i]) {
+				int pos = i*64 + __builtin_ctzll(bits[i]);
+				bits[i] &= bits[i] - 1;
+				size--;
+				return pos;
+			}
+		}
+		fprintf(stderr, "< Error > Cannot extract first set bit because bitmask is empty.\n");
+		exit(0);
 	}
+};
+
+// Number of 64-bit words in a sample bitmask: the width of the narrowest FixedBitmask that fits the cohort, or what Bitmask allocates for larger cohorts
+int sampleMaskWords(int numSamples) {
+	int words = ceil(numSamples / 64.0);
+	if (words > 16) return words;
+	int width = 1;
+	while (width < words) width *= 2;
+	return width;
+}
 
-	SubnetworkEntry(vector<int> & nodeV, Bitmask & sampleB) : isValid(true) {
-		nodes = nodeV;
-		samples = new Bitmask(sampleB);
+// Index of the lowest-order set bit of a bitmask, or -1 if it is empty
+int lowestSetBit(const llu * bits, int len) {
+	for (int i = 0; i < len; i++) {
+		if (bits[i])
+			return i * 64 + __builtin_ctzll(bits[i]);
 	}
+	return -1;
+}
+
+// Number of set bits of a bitmask at index 'from' or higher
+int countSetBitsFrom(const llu * bits, int len, int from) {
+	int count = __builtin_popcountll(bits[from / 64] >> (from % 64));
+	for (int i = from / 64 + 1; i < len; i++)
+		count += __builtin_popcountll(bits[i]);
+	return count;
+}
 
-	SubnetworkEntry(const SubnetworkEntry & Q) : isValid(Q.isValid), seedSampleIdx(Q.seedSampleIdx) {
-		nodes = Q.nodes;
-		nodeColourIdx = Q.nodeColourIdx;
-		samples = new Bitmask(Q.samples);
+struct BitmaskHasher {
+	template <class Mask>
+	std::size_t operator()(const Mask & Q) const {
+		return bitmaskKernels.hash(Q.bits, Q.len);
 	}
+};
+
+/*
+	Colour-plane index of the alteration profiles: one dense sample bitmask for every (gene, alteration) pair that occurs.
+	plane(g, c) has bit s set iff gene g has alteration c in sample s, and coloured(g) is the union of all planes of gene g.
+	Pairs that do not occur share the all-zero plane at the start of 'bits', so lookups never need to check for existence.
+*/
+struct ColourPlanes {
+	int numSamples;
+	int numColours;
+	int len;				// Number of 64-bit words in a plane
+	llu * geneColours;		// geneColours[g] = bitmask of alterations that gene g has in at least one sample
+	llu * planeOffset;		// planeOffset[g * numColours + c] = offset of plane(g, c) in 'bits'
+	llu * colouredOffset;	// colouredOffset[g] = offset of coloured(g) in 'bits'
+	llu * bits;
+	llu numPlanes;			// Number of planes in 'bits', including the all-zero plane
+
+	const llu * plane(int nodeIdx, int colourIdx) const { return bits + planeOffset[llu(nodeIdx) * numColours + colourIdx]; }
+
+	const llu * coloured(int nodeIdx) const { return bits + colouredOffset[nodeIdx]; }
 
-	~SubnetworkEntry(){
-		if (samples) {
-			delete samples;
-			samples = 0;
+	bool isColoured(int nodeIdx, int sampleIdx) const { return (coloured(nodeIdx)[sampleIdx / 64] >> (sampleIdx % 64)) & 1; }
+
+	bool hasColour(int nodeIdx, int colourIdx, int sampleIdx) const { return (plane(nodeIdx, colourIdx)[sampleIdx / 64] >> (sampleIdx % 64)) & 1; }
+
+	// Returns the bitmask of alterations that the gene has in the given sample
+	llu coloursInSample(int nodeIdx, int sampleIdx) const {
+		llu colourMask = 0;
+		if (!isColoured(nodeIdx, sampleIdx)) return colourMask;
+		for (llu rest = geneColours[nodeIdx]; rest; rest &= rest - 1) {
+			int colourIdx = __builtin_ctzll(rest);
+			if (hasColour(nodeIdx, colourIdx, sampleIdx))
+				colourMask |= llu(1) << colourIdx;
 		}
+		return colourMask;
 	}
+} colourPlanes;
 
-	void print(unordered_map<int, llu> * geneAlterations, Entry & sampleInfo, Entry & alterationInfo, int * chrArm, string * nodeNames, FILE * fout) {
+// Read/write view of a single candidate subnetwork inside a CandidateLevel
+struct SubnetworkView {
+	int size;				// Number of nodes
+	int len;				// Number of 64-bit words of the sample bitmask
+	const int * nodes;
+	const unsigned char * nodeColourIdx;
+	llu * sampleBits;
+	int * sampleCount;
+
+	int numSamples() const { return *sampleCount; }
+
+	bool hasSample(int sampleIdx) const { return (sampleBits[sampleIdx / 64] >> (sampleIdx % 64)) & 1; }
+
+	void print(const ColourPlanes & planes, Entry & sampleInfo, Entry & alterationInfo, int * chrArm, string * nodeNames, FILE * fout) const {
 		fprintf(fout, "Patients\t%d\n", this->numSamples());
-		Bitmask tempmask(this->samples);
-		while (tempmask.getSize()) {
-			int sampleIdx = tempmask.extractLowestOrderSetBitIndex();
-			int numColoured = 0;
-			for (int nodeIdx : this->nodes) {
-				if (geneAlterations[nodeIdx].count(sampleIdx))
-					numColoured++;
+		for (int i = 0; i < len; i++) {
+			for (llu rest = sampleBits[i]; rest; rest &= rest - 1) {
+				int sampleIdx = i * 64 + __builtin_ctzll(rest);
+				int numColoured = 0;
+				for (int j = 0; j < size; j++) {
+					if (planes.isColoured(nodes[j], sampleIdx))
+						numColoured++;
+				}
+				fprintf(fout, " %s(%d)", sampleInfo.names[sampleIdx].c_str(), numColoured);
 			}
-			fprintf(fout, " %s(%d)", sampleInfo.names[sampleIdx].c_str(), numColoured);
 		}
-		fprintf(fout, "\nGenes\t%d\n", this->nodes.size());
-		vector<llu> nodeColourMasks = this->getNodeColourBitmaskVector(geneAlterations);
-		for (int i = 0; i < this->nodes.size(); i++) {
-			int nodeIdx = this->nodes[i];
+		fprintf(fout, "\nGenes\t%d\n", size);
+		for (int j = 0; j < size; j++) {
+			int nodeIdx = nodes[j];
 			fprintf(fout, "%s\t", nodeNames[nodeIdx].c_str());
-			Bitmask tempmask(64);
-			tempmask.copylluBitmask(nodeColourMasks[i]);
-			while (tempmask.getSize()) {
-				int colourIdx = tempmask.extractLowestOrderSetBitIndex();
+			for (llu rest = this->getNodeColourBitmask(nodeIdx, planes); rest; rest &= rest - 1) {
+				int colourIdx = __builtin_ctzll(rest);
 				fprintf(fout, "\t%s", alterationInfo.names[colourIdx].c_str());
 			}
 			if (chrArm[nodeIdx]) {
@@ -236,236 +595,453 @@ struct SubnetworkEntry {
 		}
 	}
 
-	int numSamples() const { return this->samples->getSize(); }
+	llu getNodeColourBitmask(int nodeIdx, const ColourPlanes & planes) const {
+		const llu * coloured = planes.coloured(nodeIdx);
+		bool anyColoured = false;
+		for (int i = 0; i < len && !anyColoured; i++)
+			anyColoured = sampleBits[i] & coloured[i];
+		llu colourMask = 0;
+		colourMask--;
+		if (!anyColoured) return colourMask;
+		// A colour is kept if the node has it in every sample of the subnetwork in which it is coloured. (Not all of them are coloured if the subnetwork got extended to a sample with error.)
+		colourMask = 0;
+		for (llu rest = planes.geneColours[nodeIdx]; rest; rest &= rest - 1) {
+			int colourIdx = __builtin_ctzll(rest);
+			const llu * plane = planes.plane(nodeIdx, colourIdx);
+			bool agrees = true;
+			for (int i = 0; i < len && agrees; i++)
+				agrees = (sampleBits[i] & coloured[i] & ~plane[i]) == 0;
+			if (agrees)
+				colourMask |= llu(1) << colourIdx;
+		}
+		return colourMask;
+	}
 
-	// Returns true if the bitmask changes (shrinks), false if nothing gets changed
-	bool fixSamplesViaNode(int nodeIdx, llu nodeColourBitmask, unordered_map<int, llu> * geneAlterations) {
-		Bitmask tempmask(this->samples);
-		bool aSampleDiscarded = false;
-		while (tempmask.getSize()) {
-			int sampleIdx = tempmask.extractLowestOrderSetBitIndex();
-			// If the node is not coloured in this sample, or it is but the colours have no intersection
-			if ( !geneAlterations[nodeIdx].count(sampleIdx) || (geneAlterations[nodeIdx][sampleIdx] & nodeColourBitmask) == 0 ) {
-				this->samples->setBit(sampleIdx, 0);	// Discard this sample
-				aSampleDiscarded = true;
+	/*
+		Adds every sample that the subnetwork supports with the given error rate: no node is coloured differently from its colour in the subnetwork, and at most a fraction errorRate of its nodes are colourless.
+		Samples are checked 64 at a time. A node agrees in the samples of its colour plane and conflicts in the rest of its coloured samples, and the agreeing nodes of every sample are tallied in bit-sliced counters (slices[b] holds bit b of the 64 counts).
+	*/
+	void extendSubnetworkWithError(const ColourPlanes & planes, int numSamples, double errorRate) {
+		int maxColourless = 0;
+		while (maxColourless < size && double(maxColourless + 1) / size <= errorRate) maxColourless++;
+		int minAgree = size - maxColourless;
+		int numSlices = 32 - __builtin_clz(size);
+		llu slices[32];
+		for (int i = 0; i < len && i * 64 < numSamples; i++) {
+			llu conflict = 0;
+			memset(slices, 0, sizeof(slices[0]) * numSlices);
+			for (int j = 0; j < size; j++) {
+				llu coloured = planes.coloured(nodes[j])[i];
+				llu agree = planes.plane(nodes[j], nodeColourIdx[j])[i];
+				conflict |= coloured & ~agree;
+				for (int b = 0; b < numSlices && agree; b++) {	// Ripple-carry addition of one to the counters of the agreeing samples
+					llu carry = slices[b] & agree;
+					slices[b] ^= agree;
+					agree = carry;
+				}
+			}
+			// Samples whose count is at least minAgree, compared from the most significant slice down
+			llu greater = 0, equal = ~llu(0);
+			for (int b = numSlices - 1; b >= 0; b--) {
+				if ((minAgree >> b) & 1)
+					equal &= slices[b];
+				else {
+					greater |= equal & slices[b];
+					equal &= ~slices[b];
+				}
 			}
+			llu inCohort = (numSamples - i * 64 >= 64) ? ~llu(0) : (llu(1) << (numSamples - i * 64)) - 1;
+			sampleBits[i] |= (greater | equal) & ~conflict & inCohort;
 		}
-		return aSampleDiscarded;
+		*sampleCount = countSetBitsFrom(sampleBits, len, 0);
 	}
+};
 
-	void buildSamplesViaNode(int nodeIdx, llu nodeColourBitmask, unordered_map<int, llu> * geneAlterations, int numSamples) {
-		for (int i = 0; i < numSamples; i++) {
-			// If the node is coloured in this sample and the colours have an intersection
-			if (geneAlterations[nodeIdx].count(i) && (geneAlterations[nodeIdx][i] & nodeColourBitmask))
-				this->samples->setBit(i, 1);
-		}
+/*
+	Growable array that can move its elements to a file when memory runs short. Elements are appended to 'resident'; spill() writes them to the end of the file and frees the memory.
+	After seal(), every element is accessible by index: directly in 'resident' if nothing was ever spilled, otherwise through a shared writable mapping of the file, which the kernel pages in and out as the array is streamed. Elements appended after seal() are indexed after the next one.
+	The file is unlinked as soon as it is created, so it disappears with the process.
+*/
+template <class T>
+struct SpillableArray {
+	vector<T> resident;		// Elements that were not spilled
+	T * elements;			// All elements, valid after seal()
+	int fd;					// Spill file, -1 if nothing was spilled
+	llu numSpilled;
+	llu numMapped;			// Elements of the mapping made by seal()
+
+	SpillableArray() : elements(NULL), fd(-1), numSpilled(0), numMapped(0) {}
+
+	SpillableArray(SpillableArray && Q) noexcept : resident(move(Q.resident)), elements(Q.elements), fd(Q.fd), numSpilled(Q.numSpilled), numMapped(Q.numMapped) {
+		Q.elements = NULL;
+		Q.fd = -1;
+		Q.numSpilled = 0;
+		Q.numMapped = 0;
 	}
 
-	llu getNodeColourBitmask(int nodeIdx, unordered_map<int, llu> * geneAlterations) const {
-		llu colourMask = 0;
-		colourMask--;
-		Bitmask tempmask(this->samples);
-		while (tempmask.getSize()) {
-			int sampleIdx = tempmask.extractLowestOrderSetBitIndex();
-			if (geneAlterations[nodeIdx].count(sampleIdx))	// Required if the subnetwork got extended to this sample with error
-				colourMask &= geneAlterations[nodeIdx][sampleIdx];
+	SpillableArray(const SpillableArray &) = delete;
+
+	~SpillableArray() {
+		if (fd != -1) {
+			if (elements && numMapped) munmap(elements, numMapped * sizeof(T));
+			close(fd);
 		}
-		return colourMask;
 	}
 
-	vector<llu> getNodeColourBitmaskVector(unordered_map<int, llu> * geneAlterations) const {
-		vector<llu> nodeColourMasks(this->nodes.size());
-		for (int j = 0; j < this->nodes.size(); j++)
-			nodeColourMasks[j] = getNodeColourBitmask(this->nodes[j], geneAlterations);
-		return nodeColourMasks;
+	llu size() const { return numSpilled + resident.size(); }
+
+	llu residentBytes() const { return resident.capacity() * sizeof(T); }
+
+	T & operator[](llu i) { return elements[i]; }
+
+	const T & operator[](llu i) const { return elements[i]; }
+
+	T & back() { return resident.back(); }
+
+	void reserve(llu n) { resident.reserve(n); }
+
+	void push_back(const T & x) { resident.push_back(x); }
+
+	void insert(const T * first, const T * last) { resident.insert(resident.end(), first, last); }
+
+	void append(const SpillableArray & Q) { resident.insert(resident.end(), Q.resident.begin(), Q.resident.end()); }
+
+	void clear() { resident.clear(); }
+
+	// Keeps only the first n elements, after seal()
+	void truncate(llu n) {
+		if (fd == -1)
+			resident.resize(n);
+		else
+			numSpilled = n;
 	}
 
-	// Checks whether the subnetwork can be extended to the given sample with the given error rate; conditioned upon no node having conflicting colouring, and only colourless nodes being allowed.
-	bool supportsSampleWithError(int sampleIdx, unordered_map<int, llu> * geneAlterations, double errorRate) const {
-		int agree = 0;
-		for (int j = 0; j < this->nodes.size(); j++) {
-			int const & nodeIdx = this->nodes[j];
-			llu const & nodeColourMask = llu(1) << this->nodeColourIdx[j];
-			if (geneAlterations[nodeIdx].count(sampleIdx)) {
-				if (geneAlterations[nodeIdx][sampleIdx] & nodeColourMask)
-					agree++;
-				else 	// Colours conflict
-					return false;
+	void spill(const string & path) {
+		if (fd == -1) {
+			fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+			if (fd < 0) {
+				fprintf(stderr, "\n< Error > Cannot create spill file '%s'.\n", path.c_str());
+				exit(0);
+			}
+			unlink(path.c_str());
+		}
+		const char * data = (const char *) resident.data();
+		for (llu bytes = resident.size() * sizeof(T), written = 0; written < bytes; ) {
+			ssize_t n = write(fd, data + written, bytes - written);
+			if (n <= 0) {
+				fprintf(stderr, "\n< Error > Cannot write spill file '%s'. The disk may be full.\n", path.c_str());
+				exit(0);
 			}
+			written += n;
+		}
+		numSpilled += resident.size();
+		vector<T>().swap(resident);
+	}
+
+	void seal(const string & path) {
+		if (fd == -1) {
+			elements = resident.data();
+			return;
 		}
-		int colourless = this->nodes.size() - agree;
-		return (double(colourless)/this->nodes.size() <= errorRate);
+		spill(path);
+		if (numSpilled == 0) return;
+		if (numMapped) munmap(elements, numMapped * sizeof(T));
+		void * mapping = mmap(NULL, numSpilled * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapping == MAP_FAILED) {
+			fprintf(stderr, "\n< Error > Cannot map spill file '%s' into memory.\n", path.c_str());
+			exit(0);
+		}
+		madvise(mapping, numSpilled * sizeof(T), MADV_SEQUENTIAL);
+		elements = (T *) mapping;
+		numMapped = numSpilled;
+	}
+};
+
+/*
+	Arena of all candidate subnetworks of one size, stored as a structure of arrays and indexed by candidate id.
+	Candidate i has its nodes at nodes[i * size], their colours at nodeColourIdx[i * size] and its sample bitmask at sampleBits[i * len].
+	Candidates are only appended while the level is being filled. Indexing is valid after seal(), which maps the arrays back in if the level was spilled to disk.
+*/
+struct CandidateLevel {
+	int size;					// Number of nodes of every candidate on this level
+	int len;					// Number of 64-bit words of a sample bitmask
+	SpillableArray<int> nodes;
+	SpillableArray<unsigned char> nodeColourIdx;
+	SpillableArray<llu> sampleBits;
+	SpillableArray<int> sampleCount;
+	SpillableArray<int> exactCount;		// Samples in which every node has its colour, which the extension with errors leaves unchanged
+	SpillableArray<int> seedSampleIdx;
+
+	CandidateLevel() : size(0), len(0) {}
+
+	CandidateLevel(int size, int len) : size(size), len(len) {}
+
+	llu count() const { return seedSampleIdx.size(); }
+
+	SubnetworkView view(llu i) {
+		return SubnetworkView{ size, len, &nodes[i * size], &nodeColourIdx[i * size], &sampleBits[i * len], &sampleCount[i] };
+	}
+
+	const int * nodesOf(llu i) const { return &nodes[i * size]; }
+
+	const unsigned char * coloursOf(llu i) const { return &nodeColourIdx[i * size]; }
+
+	const llu * samplesOf(llu i) const { return &sampleBits[i * len]; }
+
+	void reserve(llu n) {
+		nodes.reserve(n * size);
+		nodeColourIdx.reserve(n * size);
+		sampleBits.reserve(n * len);
+		sampleCount.reserve(n);
+		exactCount.reserve(n);
+		seedSampleIdx.reserve(n);
 	}
 
-	void extendSubnetworkWithError(unordered_map<int, llu> * geneAlterations, Entry & sampleInfo, double errorRate) {
-		// vector<llu> nodeColourMasks = this->getNodeColourBitmaskVector(geneAlterations);
-		for (int i = 0; i < sampleInfo.indices.size(); i++) {
-			if (!(this->samples -> getBit(i)) && this->supportsSampleWithError(i, geneAlterations, errorRate)) {
-				this->samples -> setBit(i, 1);
+	void append(const CandidateLevel & Q) {
+		nodes.append(Q.nodes);
+		nodeColourIdx.append(Q.nodeColourIdx);
+		sampleBits.append(Q.sampleBits);
+		sampleCount.append(Q.sampleCount);
+		exactCount.append(Q.exactCount);
+		seedSampleIdx.append(Q.seedSampleIdx);
+	}
+
+	void clear() {
+		nodes.clear();
+		nodeColourIdx.clear();
+		sampleBits.clear();
+		sampleCount.clear();
+		exactCount.clear();
+		seedSampleIdx.clear();
+	}
+
+	void append(const int * nodeV, const unsigned char * colourV, const llu * bits, int numSamples, int numExact, int seed) {
+		nodes.insert(nodeV, nodeV + size);
+		nodeColourIdx.insert(colourV, colourV + size);
+		sampleBits.insert(bits, bits + len);
+		sampleCount.push_back(numSamples);
+		exactCount.push_back(numExact);
+		seedSampleIdx.push_back(seed);
+	}
+
+	llu residentBytes() const {
+		return nodes.residentBytes() + nodeColourIdx.residentBytes() + sampleBits.residentBytes() + sampleCount.residentBytes() + exactCount.residentBytes() + seedSampleIdx.residentBytes();
+	}
+
+	// Moves the candidates held in memory to the spill files starting with the given path
+	void spill(const string & path) {
+		nodes.spill(path + ".nodes");
+		nodeColourIdx.spill(path + ".colours");
+		sampleBits.spill(path + ".samples");
+		sampleCount.spill(path + ".counts");
+		exactCount.spill(path + ".exact");
+		seedSampleIdx.spill(path + ".seeds");
+	}
+
+	void seal(const string & path) {
+		nodes.seal(path + ".nodes");
+		nodeColourIdx.seal(path + ".colours");
+		sampleBits.seal(path + ".samples");
+		sampleCount.seal(path + ".counts");
+		exactCount.seal(path + ".exact");
+		seedSampleIdx.seal(path + ".seeds");
+	}
+
+	// Keeps the candidates i with keep[i] set, in the same order, after seal()
+	void filter(const vector<char> & keep) {
+		llu numKept = 0;
+		for (llu i = 0; i < count(); i++) {
+			if (!keep[i]) continue;
+			if (numKept != i) {
+				copy(&nodes[i * size], &nodes[(i + 1) * size], &nodes[numKept * size]);
+				copy(&nodeColourIdx[i * size], &nodeColourIdx[(i + 1) * size], &nodeColourIdx[numKept * size]);
+				copy(&sampleBits[i * len], &sampleBits[(i + 1) * len], &sampleBits[numKept * len]);
+				sampleCount[numKept] = sampleCount[i];
+				exactCount[numKept] = exactCount[i];
+				seedSampleIdx[numKept] = seedSampleIdx[i];
 			}
+			numKept++;
 		}
+		nodes.truncate(numKept * size);
+		nodeColourIdx.truncate(numKept * size);
+		sampleBits.truncate(numKept * len);
+		sampleCount.truncate(numKept);
+		exactCount.truncate(numKept);
+		seedSampleIdx.truncate(numKept);
 	}
 };
 
 struct Graph {
-	int V, E;
-	int * NSize;
-	int ** N;
+	int V;
+	llu E;				// Number of directed edges
+	llu * adjStart;		// The neighbours of node u are adj[adjStart[u]] .. adj[adjStart[u + 1] - 1]
+	int * adj;
 	string * nodeNames;
 	int * chrArm;
 	unordered_map<string, int> nodeIndices;
+
+	int degree(int nodeIdx) const { return adjStart[nodeIdx + 1] - adjStart[nodeIdx]; }
+
+	const int * neighbours(int nodeIdx) const { return adj + adjStart[nodeIdx]; }
 } G;
 
 struct Subgraph {
 	int V;
-	int * nodeNames;
-	unordered_map<int, int> nameIdx;
-	int * degrees;
-	int ** edges;
-	pair<int, int> ** incomingEdges;
+	int * nodeNames;	// nodeNames[i] = index in G of local node i
+	int * adjStart;		// The neighbours of local node i are adj[adjStart[i]] .. adj[adjStart[i + 1] - 1], as local indices
+	int * adj;
 
 	Subgraph(){}
 	~Subgraph(){
-		delete nodeNames;
-		delete degrees;
-		for (int i = 0; i < V; i++) {
-			delete [] edges[i];
-			delete [] incomingEdges[i];
-		}
-		delete edges;
-		delete incomingEdges;
+		delete [] nodeNames;
+		delete [] adjStart;
+		delete [] adj;
 	}
-	Subgraph( Graph * G, int * nodes, int numNodes ) : V(numNodes) {
+	/*
+		Induced subgraph on the given nodes. If keepEdge is given, only the edges G->neighbours(node)[k] for which keepEdge(node, k) holds are kept; it has to be symmetric.
+		localIdx is scratch indexed by the nodes of G, which has to hold -1 everywhere and is left that way. It replaces a hash map from global to local indices.
+	*/
+	Subgraph( Graph * G, int * nodes, int numNodes, vector<int> & localIdx, const function<bool(int, int)> & keepEdge = function<bool(int, int)>() ) : V(numNodes) {
 		nodeNames = new int [V];
-		degrees = new int [V];
-		edges = new int * [V];
-		incomingEdges = new pair<int, int> * [V];
-		bool * flagged = new bool[G -> V];
-		memset(degrees, 0, V * sizeof(degrees[0]));
-		memset(flagged, 0, (G -> V) * sizeof(flagged[0]));
+		adjStart = new int [V + 1];
 		for (int i = 0; i < V; i++) {
-			flagged[nodes[i]] = true;
 			nodeNames[i] = nodes[i];
-			nameIdx[ nodeNames[i] ] = i;
+			localIdx[ nodes[i] ] = i;
 		}
-		/******************************************************
-		 * Flagged all nodes that belong to current subgraph. *
-		 ******************************************************/
-		for (int i = 0; i < V; i++) {
-			int node = nodes[i];
-			int NSize = G -> NSize[node];
-			for (int j = 0; j < NSize; j++) {
-				int neighbour = G -> N[node][j];
-				if (flagged[neighbour]) {
-					degrees[i]++;
-				}
-			}
-			edges[i] = new int [ degrees[i] + 1 ];
-			incomingEdges[i] = new pair<int, int> [ degrees[i] + 1 ];
-			edges[i][ degrees[i] ] = 0;
-			incomingEdges[i][ degrees[i] ] = make_pair(0, 0);
-		}
-		/*********************************************
-		 * Extracted subgraph degrees for all nodes. *
-		 *********************************************/
+		vector<int> edges;
+		adjStart[0] = 0;
 		for (int i = 0; i < V; i++) {
 			int node = nodes[i];
-			int NSize = G -> NSize[node];
+			int NSize = G -> degree(node);
 			for (int j = 0; j < NSize; j++) {
-				int neighbour = G -> N[node][j];
-				if (flagged[neighbour]) {
-					// node -> neighbour directed edge discovered
-					// int nodeIdx = nameIdx[node];
-					int neighbourIdx = nameIdx[neighbour];
-					int & edgesIndex = edges[i][ degrees[i] ];
-					edges[i][ edgesIndex ] = neighbourIdx;
-					int incomingEdgesIndex = incomingEdges[neighbourIdx][ degrees[neighbourIdx] ].first;
-					incomingEdges[neighbourIdx][ incomingEdgesIndex ] = make_pair(i, edgesIndex);
-					edgesIndex++;
-					incomingEdges[neighbourIdx][ degrees[neighbourIdx] ] = make_pair(incomingEdgesIndex + 1, 0);
-				}
+				int neighbourIdx = localIdx[ G -> neighbours(node)[j] ];
+				if (neighbourIdx != -1 && (!keepEdge || keepEdge(node, j)))
+					edges.push_back(neighbourIdx);
 			}
+			adjStart[i + 1] = edges.size();
 		}
-		/**************************************
-		 * Build edge and incoming edge lists *
-		 **************************************/
-		delete flagged;
+		adj = new int [edges.size()];
+		copy(edges.begin(), edges.end(), adj);
+		for (int i = 0; i < V; i++)
+			localIdx[ nodes[i] ] = -1;
 	}
+
+	int degree(int i) const { return adjStart[i + 1] - adjStart[i]; }
+
+	const int * neighbours(int i) const { return adj + adjStart[i]; }
 };
 
 unordered_map<int, llu> * geneAlterations;	// geneAlterations[ i ][ j ] = c means that "gene i has colour c in patient j". The colours are bitmasks (so supporting max 64 different alteration types).
 vector< pair<int,int> > subnetworkSeeds;
 
 /*
-	Reads the input -n parameter as a collection of undirected edges (pairs of node names, separated by whitespace) and stores the information in global Graph object G.
+	Reads the network of the -n parameter into the global Graph object G, with a single pass over the memory-mapped file. Node names are interned by sorting their occurrences, so that the indices follow the order in which the nodes first appear in an edge (the lexicographically smaller endpoint first), and edges are deduplicated by sorting pairs of indices.
+	The adjacency lists are stored in CSR form, each sorted by neighbour index.
 */
 void readUndirectedNetwork(const char * filename) {
 	fprintf(stderr, "Reading the network... ");
 	int timerStart = clock();
-	unordered_set<pair<string, string>, stringPairHash> uniqueEdges;
-	char u[1000], v[1000];
-	FILE * fin = NULL;
-	if (!(fin = fopen(filename, "r"))) {
+	int fd = open(filename, O_RDONLY);
+	struct stat fileInfo;
+	if (fd < 0 || fstat(fd, &fileInfo) < 0) {
 		fprintf(stderr, "\n< Error > Cannot open file '%s'. Please make sure the file exists.\n", filename);
 		exit(0);
 	}
-	G.V = 0;
-	while (fscanf(fin, "%s%s", u, v) == 2) {
-		char * a = u, * b = v;
-		if (strcmp(a, b) > 0) swap(a, b);
-		else if (strcmp(a, b) == 0) continue;
-		pair<string, string> e = make_pair(string(a), string(b));
-		if (!uniqueEdges.count(e)) {	// Previously NOT seen undirected edge
-			uniqueEdges.insert(e);
-			if (!G.nodeIndices.count(e.first)) {
-				G.nodeIndices[e.first] = G.V;
-				G.V++;
-			}
-			if (!G.nodeIndices.count(e.second)) {
-				G.nodeIndices[e.second] = G.V;
-				G.V++;
-			}
+	llu fileSize = fileInfo.st_size;
+	const char * text = NULL;
+	if (fileSize) {
+		text = (const char *) mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (text == MAP_FAILED) {
+			fprintf(stderr, "\n< Error > Cannot map file '%s' into memory.\n", filename);
+			exit(0);
 		}
 	}
-	fclose(fin);
-	G.E = uniqueEdges.size() * 2;
-
-	G.NSize = new int [G.V];
-	G.N = new int * [G.V];
+	// Tokenizing: every two consecutive whitespace-separated words form an edge
+	vector< pair<llu, int> > tokens;	// (offset, length) of every word
+	for (llu pos = 0; pos < fileSize; ) {
+		while (pos < fileSize && isspace(text[pos])) pos++;
+		llu start = pos;
+		while (pos < fileSize && !isspace(text[pos])) pos++;
+		if (pos > start)
+			tokens.push_back(make_pair(start, int(pos - start)));
+	}
+	llu numLines = tokens.size() / 2;
+	auto compareTokens = [&](llu i, llu j) {
+		int cmp = memcmp(text + tokens[i].first, text + tokens[j].first, min(tokens[i].second, tokens[j].second));
+		return cmp ? cmp : tokens[i].second - tokens[j].second;
+	};
+	// occurrences[2 * line] is the lexicographically smaller endpoint of the line, occurrences[2 * line + 1] the larger one. Self-loops are skipped.
+	vector<llu> occurrences;
+	occurrences.reserve(2 * numLines);
+	for (llu line = 0; line < numLines; line++) {
+		int cmp = compareTokens(2 * line, 2 * line + 1);
+		if (cmp == 0) continue;
+		occurrences.push_back(cmp < 0 ? 2 * line : 2 * line + 1);
+		occurrences.push_back(cmp < 0 ? 2 * line + 1 : 2 * line);
+	}
+	// Sorting occurrence positions by name groups equal names, with the first appearance of each name at the start of its group
+	vector<llu> order(occurrences.size());
+	for (llu i = 0; i < order.size(); i++) order[i] = i;
+	sort(order.begin(), order.end(), [&](llu a, llu b) {
+		int cmp = compareTokens(occurrences[a], occurrences[b]);
+		return cmp ? cmp < 0 : a < b;
+	});
+	vector<llu> firstAppearance;		// Position of the first occurrence of each distinct name, in name order
+	vector<int> nameGroup(occurrences.size());
+	for (llu i = 0; i < order.size(); i++) {
+		if (i == 0 || compareTokens(occurrences[order[i - 1]], occurrences[order[i]]) != 0)
+			firstAppearance.push_back(order[i]);
+		nameGroup[order[i]] = firstAppearance.size() - 1;
+	}
+	vector<int> groupNodeIdx(firstAppearance.size());
+	{
+		vector<int> groups(firstAppearance.size());
+		for (int i = 0; i < groups.size(); i++) groups[i] = i;
+		sort(groups.begin(), groups.end(), [&](int a, int b) { return firstAppearance[a] < firstAppearance[b]; });
+		for (int i = 0; i < groups.size(); i++) groupNodeIdx[ groups[i] ] = i;
+	}
+	G.V = firstAppearance.size();
 	G.nodeNames = new string[G.V];
 	G.chrArm = new int [G.V];
-	memset(G.NSize, 0, sizeof(G.NSize[0]) * G.V);
 	memset(G.chrArm, 0, sizeof(G.chrArm[0]) * G.V);
-
-	for (auto e: uniqueEdges) {
-		int idx1 = G.nodeIndices[e.first];
-		if (G.nodeNames[idx1].size() == 0) G.nodeNames[idx1] = e.first;
-
-		int idx2 = G.nodeIndices[e.second];
-		if (G.nodeNames[idx2].size() == 0) G.nodeNames[idx2] = e.second;
-
-		G.NSize[idx1]++;
-		G.NSize[idx2]++;
+	for (int group = 0; group < firstAppearance.size(); group++) {
+		auto & token = tokens[ occurrences[ firstAppearance[group] ] ];
+		int nodeIdx = groupNodeIdx[group];
+		G.nodeNames[nodeIdx] = string(text + token.first, token.second);
+		G.nodeIndices[ G.nodeNames[nodeIdx] ] = nodeIdx;
 	}
-
-	for (int i = 0; i < G.V; i++) {
-		G.N[i] = new int[ G.NSize[i] ];
+	// Deduplicating the undirected edges as sorted (smaller index, larger index) pairs
+	vector<llu> edges(occurrences.size() / 2);
+	for (llu i = 0; i < edges.size(); i++) {
+		llu a = groupNodeIdx[ nameGroup[2 * i] ];
+		llu b = groupNodeIdx[ nameGroup[2 * i + 1] ];
+		edges[i] = (min(a, b) << 32) | max(a, b);
 	}
-
-	int * tempNSize = new int [G.V];
-	memset(tempNSize, 0, sizeof(tempNSize[0]) * G.V );
-
-	for (auto e: uniqueEdges) {
-		int idx1 = G.nodeIndices[e.first];
-		int idx2 = G.nodeIndices[e.second];
-		G.N[ idx1 ][ tempNSize[idx1] ] = idx2;
-		G.N[ idx2 ][ tempNSize[idx2] ] = idx1;
-		tempNSize[idx1]++;
-		tempNSize[idx2]++;
+	sort(edges.begin(), edges.end());
+	edges.erase(unique(edges.begin(), edges.end()), edges.end());
+	if (fileSize)
+		munmap((void *) text, fileSize);
+	close(fd);
+	G.E = edges.size() * 2;
+	G.adjStart = new llu [G.V + 1];
+	G.adj = new int [G.E];
+	memset(G.adjStart, 0, sizeof(G.adjStart[0]) * (G.V + 1));
+	for (llu e : edges) {
+		G.adjStart[(e >> 32) + 1]++;
+		G.adjStart[(e & 0xFFFFFFFF) + 1]++;
+	}
+	for (int i = 0; i < G.V; i++)
+		G.adjStart[i + 1] += G.adjStart[i];
+	// Pairs are sorted, so every node receives its smaller neighbours before its larger ones, in increasing order
+	vector<llu> fill(G.adjStart, G.adjStart + G.V);
+	for (llu e : edges) {
+		int idx1 = e >> 32;
+		int idx2 = e & 0xFFFFFFFF;
+		G.adj[ fill[idx1]++ ] = idx2;
+		G.adj[ fill[idx2]++ ] = idx1;
 	}
-	delete [] tempNSize;
 	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
-	fprintf(stderr, "\tInput network contains %d nodes and %d undirected edges.\n", G.V, G.E / 2);
+	fprintf(stderr, "\tInput network contains %d nodes and %llu undirected edges.\n", G.V, G.E / 2);
 }
 
 /*
@@ -520,32 +1096,88 @@ void readExcludeInfo(const char * filename) {
 }
 
 /*
-	Reads the input -l parameter as a collection of "sample gene alterationType" triples, separated by whitespace.
+	Reads the input -l parameter as a collection of "sample gene alterationType" triples, separated by whitespace, in a single streaming pass. The file may be gzip-compressed (zlib reads uncompressed files unchanged).
+	The decompressed text is split into whitespace-separated (sample, gene, alteration) triples straight from a large buffer. Samples, genes and alterations are interned in order of first appearance among the rows whose gene is in the network.
 */
 void readAlterationProfiles(const char * filename) {
 	fprintf(stderr, "Reading the alteration profiles... ");
 	int timerStart = clock();
-	char sample[1000], gene[1000], alterationType[1000];
-	FILE * fin = NULL;
-	if (!(fin = fopen(filename, "r"))) {
+	gzFile fin = gzopen(filename, "rb");
+	if (!fin) {
 		fprintf(stderr, "\n< Error > Cannot open file '%s'. Please make sure the file exists.\n", filename);
 		exit(0);
 	}
-	while (fscanf(fin, "%s%s%s", sample, gene, alterationType) == 3) {
-		if (!G.nodeIndices.count(string(gene))) continue;
-		if (!samples.indices.count(string(sample))) {
-			int idx = samples.indices.size();
-			samples.indices[string(sample)] = idx;
+	gzbuffer(fin, 1 << 20);
+	geneAlterations = new unordered_map<int, llu> [ G.V ];
+	vector<int> geneOfNode(G.V, -1);
+	string fields[3];	// sample, gene, alteration type of the current row
+	int numFields = 0;
+	int sampleIndex = -1;
+	const int bufferSize = 1 << 24;
+	char * buffer = new char [bufferSize];
+	int bufferLen = 0;
+	for (bool atEnd = false; !atEnd; ) {
+		int bytesRead = gzread(fin, buffer + bufferLen, bufferSize - bufferLen);
+		if (bytesRead < 0) {
+			fprintf(stderr, "\n< Error > Cannot read file '%s'. The file may be corrupted.\n", filename);
+			exit(0);
 		}
-		if (!genes.indices.count(string(gene))) {
-			int idx = genes.indices.size();
-			genes.indices[string(gene)] = idx;
+		atEnd = (bytesRead == 0);
+		bufferLen += bytesRead;
+		int pos = 0;
+		int consumed = 0;
+		while (true) {
+			while (pos < bufferLen && isspace(buffer[pos])) pos++;
+			int start = pos;
+			while (pos < bufferLen && !isspace(buffer[pos])) pos++;
+			if (pos == start || (pos == bufferLen && !atEnd)) {	// No more words, or the last word may continue in the next chunk
+				consumed = start;
+				break;
+			}
+			int fieldIdx = numFields++;
+			if (fieldIdx == 0 && fields[0].size() == size_t(pos - start) && memcmp(fields[0].data(), buffer + start, pos - start) == 0)
+				continue;	// Same sample as in the previous row
+			fields[fieldIdx].assign(buffer + start, pos - start);
+			if (fieldIdx == 0)
+				sampleIndex = -1;
+			if (numFields < 3) continue;
+			numFields = 0;
+			auto nodeIt = G.nodeIndices.find(fields[1]);
+			if (nodeIt == G.nodeIndices.end()) continue;
+			int geneIndex = nodeIt->second;
+			if (geneOfNode[geneIndex] == -1) {
+				geneOfNode[geneIndex] = genes.indices.size();
+				genes.indices[ fields[1] ] = geneOfNode[geneIndex];
+			}
+			if (sampleIndex == -1) {
+				auto sampleIt = samples.indices.find(fields[0]);
+				if (sampleIt == samples.indices.end()) {
+					sampleIndex = samples.indices.size();
+					samples.indices[ fields[0] ] = sampleIndex;
+				}
+				else
+					sampleIndex = sampleIt->second;
+			}
+			auto alterationIt = alterations.indices.find(fields[2]);
+			int alterationIndex;
+			if (alterationIt == alterations.indices.end()) {
+				alterationIndex = alterations.indices.size();
+				alterations.indices[ fields[2] ] = alterationIndex;
+			}
+			else
+				alterationIndex = alterationIt->second;
+			subnetworkSeeds.push_back(make_pair(sampleIndex, geneIndex));
+			geneAlterations[geneIndex][sampleIndex] |= (llu(1) << alterationIndex);
 		}
-		if (!alterations.indices.count(string(alterationType))) {
-			int idx = alterations.indices.size();
-			alterations.indices[string(alterationType)] = idx;
+		if (consumed == 0 && bufferLen == bufferSize) {
+			fprintf(stderr, "\n< Error > File '%s' contains a word longer than %d characters.\n", filename, bufferSize);
+			exit(0);
 		}
+		memmove(buffer, buffer + consumed, bufferLen - consumed);
+		bufferLen -= consumed;
 	}
+	delete [] buffer;
+	gzclose(fin);
 	samples.names = new string[samples.indices.size()];
 	genes.names = new string[genes.indices.size()];
 	alterations.names = new string[ alterations.indices.size() ];
@@ -558,437 +1190,1752 @@ void readAlterationProfiles(const char * filename) {
 	for (auto it : alterations.indices) {
 		alterations.names[it.second] = it.first;
 	}
-	rewind(fin);
-	geneAlterations = new unordered_map<int, llu> [ G.V ];
-	while (fscanf(fin, "%s%s%s", sample, gene, alterationType) == 3) {
-		if (!genes.indices.count(string(gene))) continue;
-		int geneIndex = G.nodeIndices[string(gene)];
-		int sampleIndex = samples.indices[sample];
-		// int subnetworkIndex = G.nodeIndices[string(gene)] + sampleIndex * G.V;
-		subnetworkSeeds.push_back(make_pair(sampleIndex, geneIndex));
-		int alterationIndex = alterations.indices[alterationType];
-		if ( !geneAlterations[geneIndex].count(sampleIndex) )
-			geneAlterations[geneIndex][sampleIndex] = 0;
-		llu bitMask = (llu(1) << alterationIndex);
-		bitMask |= geneAlterations[geneIndex][sampleIndex];
-		geneAlterations[geneIndex][sampleIndex] = bitMask;
-	}
-	fclose(fin);
 	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
 	fprintf( stderr, "\tThere are %lu samples, with a total of %lu genes, harboring %lu different alterations.\n", samples.indices.size(), genes.indices.size(), alterations.indices.size() );
 	fprintf(stderr, "\tThere are %lu possible subnetwork seeds.\n", subnetworkSeeds.size());
 }
 
 /*
-	The main function that preprocesses the data and runs the CPLEX ILP solver.
+	Edge support index: for every edge of the network and every pair of colours of its endpoints, the samples in which both endpoints have these colours.
+	Only the pairs that are recurrent in at least t samples are kept, as no candidate subnetwork can contain an edge whose coloured endpoints are supported by fewer samples.
+	Edges are numbered along the adjacency lists, so G.neighbours(u)[k] is edge G.adjStart[u] + k, and its supported pairs are pairStart[e] .. pairStart[e + 1] - 1.
 */
-void runSolver(int S, int t, int K, double errorRate, const char * folderName, int threads, int seconds, int minColours) {
-	/*
-		STAGE 1: Identification of connected components among the coloured nodes in the PPI network.
-		Purpose: Minimization of the flow network size for each possible seed.
-	*/
-	fprintf(stderr, "Finding coloured patient-specific connected components... ");
-	int timerStart = clock();
-	int ** node_CCIndex = new int * [samples.indices.size()];	// node_CCIndex[sampleIdx][nodeIdx] = CCIndex
-	int * CC_count = new int [samples.indices.size()];	// CC_count[sampleIdx] = numberOfConnectedColouredComponents
-	int * nodeStack = new int [G.V + 1];
-	int * temp = new int [G.V + 1];
-	Subgraph *** CC = new Subgraph ** [samples.indices.size()];
-	for (int sampleIdx = 0; sampleIdx < samples.indices.size(); sampleIdx++) {
-		node_CCIndex[sampleIdx] = new int [G.V];
-		memset(node_CCIndex[sampleIdx], -1, sizeof(node_CCIndex[sampleIdx][0])*G.V);
-		CC_count[sampleIdx] = 0;	// Number of connected components
-		int & num_of_CCs = CC_count[sampleIdx];
-		int nodeStackSize = 0;
-		for (int j = 0; j < G.V; j++) {
-			if (geneAlterations[j].count(sampleIdx) && node_CCIndex[sampleIdx][j] == -1) {	// node is coloured and not assigned to a connected component
-				node_CCIndex[sampleIdx][j] = num_of_CCs++;
-				nodeStack[nodeStackSize++] = j;
-				while (nodeStackSize) {
-					int node = nodeStack[--nodeStackSize];
-					for (int j1 = 0; j1 < G.NSize[node]; j1++) {
-						int const & neighbour = G.N[node][j1];
-						if (geneAlterations[neighbour].count(sampleIdx) && node_CCIndex[sampleIdx][neighbour] == -1) {	// neighbour is coloured and not assigned to a connected component
-							node_CCIndex[sampleIdx][neighbour] = node_CCIndex[sampleIdx][node];
-							nodeStack[nodeStackSize++] = neighbour;
-						}
-					}
-				}
-			}
-		}
-		/***************************************************************************************************************************************
-		 * Computed number of connected coloured components in the sample. (CC_count[sampleIdx])											   *
-		 * For every node, assigned index of the connected coloured component it belongs to in the sample. (node_CCIndex[sampleIdx][nodeIdx])  *
-		 ***************************************************************************************************************************************/
-		int * CCSizes = temp;
-		memset(CCSizes, 0, num_of_CCs * sizeof(CCSizes[0]));
-		for (int j = 0; j < G.V; j++) if (node_CCIndex[sampleIdx][j] != -1) CCSizes[ node_CCIndex[sampleIdx][j] ]++;
-		for (int i = 1; i < num_of_CCs; i++) CCSizes[i] += CCSizes[i - 1];
-		int totalColouredNodes = CCSizes[num_of_CCs - 1];
-		for (int j = 0; j < G.V; j++) if (node_CCIndex[sampleIdx][j] != -1) nodeStack[ --CCSizes[ node_CCIndex[sampleIdx][j] ] ] = j;
-		/***************************************************************************************
-		 * Partitioned nodes of the sample network based on coloured connected component index *
-		 ***************************************************************************************/
-		CC[sampleIdx] = new Subgraph * [num_of_CCs];
-		for (int i = 0, CCIndex = 0; i < totalColouredNodes; i++, CCIndex++) {
-			int j = i + 1;
-			while (j < totalColouredNodes && node_CCIndex[sampleIdx][nodeStack[j]] == node_CCIndex[sampleIdx][nodeStack[i]]) j++;
-			CC[sampleIdx][CCIndex] = new Subgraph(&G, nodeStack + i, j - i);
-			i = j - 1;
-		}
-		/****************************************************************
-		 * Constructed subgraphs based on connected coloured components *
-		 ****************************************************************/
-	}
-	delete [] nodeStack;
-	delete [] temp;
-	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+struct EdgeSupportIndex {
+	int len;						// Number of 64-bit words of a sample bitmask
+	llu * recurrentColours;			// recurrentColours[g] = colours that gene g has in at least t samples
+	llu * pairStart;
+	llu * pairBits;					// Samples of each pair, len words per pair
 
-	// // 
-	// // STAGE 1.5: Checking the number of pairs of differently coloured nodes that occur in at least 't' patients
-	// // 
-	// fprintf(stderr, "Checking the number of pairs of differently coloured neighbour nodes that occur in at least %d patients.\n", t); timerStart = clock();
-	// llu colourfulPairs = 0;
-	// unordered_set< llu > matchedPairs;
-	// for (int k = 0; k < subnetworkSeeds.size(); k++) {
-	// 	fprintf(stderr, "\r%.1lf%%", 100*double(k + 1) / double(subnetworkSeeds.size()));
-	// 	auto & seedInfo 	= subnetworkSeeds[k];
-	// 	int sampleIdx		= seedInfo.first;
-	// 	int nodeIdx			= seedInfo.second;
-	// 	int CCIndex			= node_CCIndex[sampleIdx][nodeIdx];
-	// 	int nodeInternalIdx	= CC[sampleIdx][CCIndex] -> nameIdx[nodeIdx];
-	// 	int NSize			= CC[sampleIdx][CCIndex] -> degrees[nodeInternalIdx];
-	// 	for (int nIdx = 0; nIdx < NSize; nIdx++) {	// Going through all the neighbours of the current node of the current subnetwork
-	// 		int neighbourInternalIdx	= CC[sampleIdx][CCIndex] -> edges[nodeInternalIdx][nIdx];
-	// 		int neighbourIdx			= CC[sampleIdx][CCIndex] -> nodeNames[neighbourInternalIdx];
-	// 		llu a = nodeIdx;
-	// 		llu b = neighbourIdx;
-	// 		llu r = (a < b) ? a * G.V + b : b * G.V + a;
-	// 		if (matchedPairs.count(r))
-	// 			continue;
-	// 		Bitmask nodeColours(64);
-	// 		Bitmask neighbourColours(64);
-	// 		nodeColours.copylluBitmask(geneAlterations[nodeIdx][sampleIdx]);
-	// 		neighbourColours.copylluBitmask(geneAlterations[neighbourIdx][sampleIdx]);
-	// 		while (nodeColours.getSize()) {
-	// 			int nodeColourIndex = nodeColours.extractLowestOrderSetBitIndex();
-	// 			llu nodeColourMask = llu(1) << nodeColourIndex;
-	// 			Bitmask tempmask(neighbourColours);
-	// 			while (tempmask.getSize()) {
-	// 				int neighbourColourIndex = tempmask.extractLowestOrderSetBitIndex();
-	// 				llu neighbourColourMask = llu(1) << neighbourColourIndex;
-	// 				// We isolated a pair of colours
-	// 				if (nodeColourMask ^ neighbourColourMask) {	// We have two different colours
-	// 					llu sampleCount = 0;
-	// 					for (int i = 0; i < samples.indices.size(); i++) {
-	// 						if (geneAlterations[nodeIdx].count(i) && (geneAlterations[nodeIdx][i] & nodeColourMask) && geneAlterations[neighbourIdx].count(i) && (geneAlterations[neighbourIdx][i] & neighbourColourMask))	// Identical colour match
-	// 							sampleCount++;
-	// 					}
-	// 					if (sampleCount >= t) 
-	// 						matchedPairs.insert(r);
-	// 				}
-	// 			}
-	// 		}
-	// 	}
-	// }
-	// fprintf(stderr, "\r%llu colourful neighbour pairs found. (%.2lf seconds)\n", (llu) matchedPairs.size(), double(clock() - timerStart) / CLOCKS_PER_SEC);
+	llu edgeId(int nodeIdx, int k) const { return G.adjStart[nodeIdx] + k; }
 
-	// Allocation
-	const int numPatients = samples.indices.size();
-	vector<SubnetworkEntry> * candidateSubnetworks = new vector<SubnetworkEntry> [S];
+	bool isSupported(int nodeIdx, int k) const {
+		llu e = edgeId(nodeIdx, k);
+		return pairStart[e + 1] > pairStart[e];
+	}
 
-	//
-	//	STAGE 2: Initialization of the candidate subnetwork discovery process with the single-node networks of all coloured nodes.
-	//
-	fprintf(stderr, "Constructing initial coloured single-node subnetworks...\n"); timerStart = clock();
-	for (int k = 0, lastProg = 0; k < subnetworkSeeds.size(); k++) {
-		int progress = 1000 * double(k + 1) / double(subnetworkSeeds.size());
-		if (progress > lastProg) {
-			fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
-			lastProg = progress;
+	// Checks whether the edge is supported by a pair of colours that its endpoints have in the given sample
+	bool isSupportedIn(int nodeIdx, int k, int sampleIdx) const {
+		llu e = edgeId(nodeIdx, k);
+		for (llu p = pairStart[e]; p < pairStart[e + 1]; p++) {
+			if ((pairBits[p * len + sampleIdx / 64] >> (sampleIdx % 64)) & 1)
+				return true;
 		}
-		auto & seedInfo = subnetworkSeeds[k];
-		int sampleIdx	= seedInfo.first;
-		int nodeIdx		= seedInfo.second;
-		Bitmask nodeColourMask(64);
-		nodeColourMask.copylluBitmask(geneAlterations[nodeIdx][sampleIdx]);
-		while (nodeColourMask.getSize()) {
-			int colourIndex = nodeColourMask.extractLowestOrderSetBitIndex();
-			// if (alterations.names[colourIndex] == "EXPROUT")
-			// if (alterations.names[colourIndex] != "EXPROUT")	// Using only expression outlier seeds
-			// if (alterations.names[colourIndex] == "EXPROUT" || alterations.names[colourIndex] == "AMP")
-				// continue;	// Not using expression-outlier seeds.
-			SubnetworkEntry newEntry(numPatients);
-			newEntry.seedSampleIdx = sampleIdx;
-			newEntry.isValid = true;
-			newEntry.nodes.push_back(nodeIdx);
-			newEntry.nodeColourIdx.push_back(colourIndex);
-			llu requiredColourBitmask = llu(1) << colourIndex;
-			newEntry.buildSamplesViaNode(nodeIdx, requiredColourBitmask, geneAlterations, samples.indices.size());
-			if (newEntry.numSamples() >= t)
-				candidateSubnetworks[0].push_back(newEntry);
-		}
-	}
-	fprintf(stderr, "\rDone. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+		return false;
+	}
+} edgeSupport;
 
-	//
-	//	STAGE 3: Incremental identification of valid candidate subnetworks with n nodes by extending already identified subnetworks with n-1 nodes.
-	//
-	llu * visitedNode = new llu[G.V + 1];
-	llu * nodesHash = new llu [G.V * S + 1];
-	unordered_set<Bitmask, BitmaskHasher> * nodesHash_buckets = new unordered_set<Bitmask, BitmaskHasher> [G.V * S + 1];
-	memset(visitedNode, 0, sizeof(visitedNode[0])*(G.V + 1));
-	memset(nodesHash, 0, sizeof(nodesHash[0])*(G.V * S + 1));
-	llu visitedIdx			= 0;
-	llu hashIdx				= 0;
-	llu totalNumSubgraphs	= candidateSubnetworks[0].size();
-	llu numContained		= 0;
-	timerStart = clock();
-	for (int cycle = 1; cycle < S; cycle++) {
-		fprintf(stderr, "\nCurrent number of subgraphs is %llu. Constructing all candidate subnetworks of size %d...\n", totalNumSubgraphs, cycle + 1);
-		hashIdx++;	// We want unique networks for each network size
-		for (int i = 0, lastProg = 0; i < candidateSubnetworks[cycle - 1].size(); i++) {
-			int progress = 1000 * double(i + 1) / double(candidateSubnetworks[cycle - 1].size());
-			if (progress > lastProg) {
-				fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
-				lastProg = progress;
+/*
+	Runs worker(threadIdx) on the given number of threads and waits for all of them to finish. The calling thread acts as thread 0.
+*/
+void runInParallel(int threads, const function<void(int)> & worker) {
+	vector<thread> pool;
+	for (int threadIdx = 1; threadIdx < threads; threadIdx++)
+		pool.push_back(thread(worker, threadIdx));
+	worker(0);
+	for (thread & th : pool)
+		th.join();
+}
+
+// Counters of the subnetworks found during enumeration, including the ones that are not stored
+struct EnumerationStats {
+	vector<llu> numFound;		// numFound[sizeIdx] = recurrent subnetworks with sizeIdx + 1 nodes
+	llu numContained;			// Subnetworks with a sample-wise-lossless extension
+	vector<llu> colourCount;	// colourCount[c] = subnetworks that are not contained and have c colours among their nodes
+	llu numImproperlyColoured;	// Subnetworks that are not contained but have fewer than minColours colours
+
+	EnumerationStats() {}
+
+	EnumerationStats(int S, int numColours) : numFound(S, 0), numContained(0), colourCount(numColours + 1, 0), numImproperlyColoured(0) {}
+
+	void add(const EnumerationStats & Q) {
+		for (int i = 0; i < numFound.size(); i++) numFound[i] += Q.numFound[i];
+		for (int i = 0; i < colourCount.size(); i++) colourCount[i] += Q.colourCount[i];
+		numContained += Q.numContained;
+		numImproperlyColoured += Q.numImproperlyColoured;
+	}
+};
+
+// Neighbour that extends the current node set of a SeedEnumerator into a canonical child
+struct CanonicalExtension {
+	int internalIdx;		// Index of the neighbour in the coloured component of the seed sample
+	llu adjacency;			// Positions of the subnetwork nodes adjacent to the neighbour
+	int colouringBegin;		// Colourings [colouringBegin, colouringEnd) of the child in the buffers of its size
+	int colouringEnd;
+};
+
+/*
+	STAGE 3 for a single seed sample: enumerates by reverse search every connected coloured subnetwork of at most S nodes inside the coloured graph of the seed that is recurrent in at least t samples.
+	The canonical parent of a node set is obtained by removing its highest-index node whose removal keeps it connected. A node set is therefore only extended by a neighbour that becomes its highest-index non-cut node, so each node set is created exactly once per seed sample and no deduplication table is needed.
+	A node set is created together with all of its recurrent colourings. Colourings with the same samples are merged into the first one, as they are the same candidate to the selection; their extensions have the same samples as well.
+	Every sample in the support of a subnetwork creates it, so it is stored only by the lowest-index one. The other seeds still extend it, as its extensions may lose the lower-index samples, unless fewer than t samples of the support remain from the seed onwards.
+	In canonical-seed mode (seedSampleIdx == -1) the enumeration runs once over the recurrent network instead, with every colour a node has in at least t samples, so each subnetwork is grown exactly once and its seed is the lowest-index sample of its support.
+	Subnetworks that are contained in a larger one with the same samples (checked when k < S), or that have fewer than minColours colours, are counted in the stats but never stored.
+*/
+template <class Mask>
+struct SeedEnumerator {
+	int S, t, minColours;
+	int seedSampleIdx;
+	Subgraph * comp;
+	const llu * networkColours;		// Colours of the nodes of the recurrent network, used in canonical-seed mode
+	vector<CandidateLevel> * levels;	// (*levels)[sizeIdx] receives the subnetworks with sizeIdx + 1 nodes that are stored by the seed
+	EnumerationStats stats;			// Accumulated over all calls
+	// Current node set, one entry per position
+	vector<int> nodes;
+	vector<int> internalIdx;
+	vector<llu> adjacency;			// adjacency[j] = positions adjacent to position j
+	// Colourings of the node sets of every size: colourings[j] holds j + 1 colours per colouring, colouringSamples[j] its samples and colouringCounts[j] their number
+	vector< vector<unsigned char> > colourings;
+	vector< vector<llu> > colouringSamples;
+	vector< vector<int> > colouringCounts;
+	vector< vector<char> > contained;	// contained[j][i] = whether colouring i of the current node set of j + 1 nodes has a sample-wise-lossless extension
+	vector< vector<CanonicalExtension> > children;
+	Mask extended;
+	// Scratch indexed by internal node index
+	vector<int> position;			// Position of the node in the current subnetwork, -1 if it is not in it
+	vector<llu> seen;
+	vector<llu> neighbourAdjacency;
+	vector<int> neighbours;
+	llu seenIdx;
+
+	SeedEnumerator(int S, int t, int minColours, int numSamples, int numColours) : S(S), t(t), minColours(minColours), stats(S, numColours), nodes(S), internalIdx(S), adjacency(S), colourings(S), colouringSamples(S), colouringCounts(S), contained(S), children(S), extended(numSamples), seenIdx(0) {}
+	// Enumerates the subnetworks grown from the coloured components of the given seed sample
+	void enumerate(int sampleIdx, Subgraph ** CCs, int numCCs, vector<CandidateLevel> & output) {
+		seedSampleIdx	= sampleIdx;
+		levels			= &output;
+		for (int CCIndex = 0; CCIndex < numCCs; CCIndex++)
+			enumerateFrom(CCs[CCIndex], 0, CCs[CCIndex] -> V);
+	}
+
+	// Enumerates, in canonical-seed mode, the subnetworks of the recurrent network whose first node is one of the roots [rootBegin, rootEnd)
+	void enumerateNetwork(Subgraph * network, const llu * colours, int rootBegin, int rootEnd, vector<CandidateLevel> & output) {
+		seedSampleIdx	= -1;
+		networkColours	= colours;
+		levels			= &output;
+		enumerateFrom(network, rootBegin, rootEnd);
+	}
+
+	void enumerateFrom(Subgraph * graph, int rootBegin, int rootEnd) {
+		comp = graph;
+		if (position.size() < comp -> V) {
+			position.resize(comp -> V, -1);
+			seen.resize(comp -> V, 0);
+			neighbourAdjacency.resize(comp -> V);
+		}
+		for (int u = rootBegin; u < rootEnd; u++) {
+			int nodeIdx = comp -> nodeNames[u];
+			colourings[0].clear();
+			colouringSamples[0].clear();
+			colouringCounts[0].clear();
+			for (llu colours = this->nodeColours(nodeIdx); colours; colours &= colours - 1) {
+				int colourIdx = __builtin_ctzll(colours);
+				extended.copyBits(colourPlanes.plane(nodeIdx, colourIdx));
+				if (extended.getSize() >= t && this->canBeCanonical(extended))
+					addColouring(0, 0, NULL, colourIdx);
 			}
-			SubnetworkEntry & subnetInfo = candidateSubnetworks[cycle - 1][i];
-			visitedIdx++;	// New visited flag for each new subnetwork that is attempted to be extended
-			llu subnetHash = 0;
-			// Marking nodes visited and calculating the hash value of the subnetwork nodes
-			for (int nodeIdx : subnetInfo.nodes) {
-				visitedNode[nodeIdx] = visitedIdx;
-				subnetHash += nodeIdx;
+			if (colouringCounts[0].size()) {
+				push(0, u, 0);
+				expand(1, 0, colouringCounts[0].size());
+				pop(0);
 			}
-			int & sampleIdx = subnetInfo.seedSampleIdx;
-			// Exploring neighbours and constructing new subnetworks of size greater by 1
-			for (int nodeIdx : subnetInfo.nodes) {	// We test neighbours of every node in the current subnetwork that we are seeking to extend
-				int CCIndex			= node_CCIndex[sampleIdx][nodeIdx];
-				int nodeInternalIdx	= CC[sampleIdx][CCIndex] -> nameIdx[nodeIdx];
-				int NSize			= CC[sampleIdx][CCIndex] -> degrees[nodeInternalIdx];
-				for (int nIdx = 0; nIdx < NSize; nIdx++) {	// Going through all the neighbours of the current node of the current subnetwork
-					int neighbourInternalIdx	= CC[sampleIdx][CCIndex] -> edges[nodeInternalIdx][nIdx];
-					int neighbourIdx			= CC[sampleIdx][CCIndex] -> nodeNames[neighbourInternalIdx];
-					if (geneAlterations[neighbourIdx].count(sampleIdx) && visitedNode[neighbourIdx] < visitedIdx) {	// The node is actually coloured and we haven't tried it yet with the current subnetwork
-						visitedNode[neighbourIdx] = visitedIdx;
-						llu newHash = subnetHash + neighbourIdx;	// Sum of a combination of unique 'cycle + 1' numbers has to be unique itself.
-						if (nodesHash[newHash] < hashIdx) {	// First time visiting this bucket. Clear it.
-							nodesHash[newHash] = hashIdx;
-							nodesHash_buckets[newHash].clear();
-						}
-						// We may have same subnetwork but with different patients involved due to different node colouring. That forces us to continue and compare against patient bitmasks for this hash bucket.
-						// Calculate the patient bitmask with this node added
-						Bitmask alterationBitmask(64);
-						alterationBitmask.copylluBitmask(geneAlterations[neighbourIdx][sampleIdx]);
-						while (alterationBitmask.getSize()) {	// Go through its colours.
-							int alterationIndex = alterationBitmask.extractLowestOrderSetBitIndex();
-							llu singleColourBitmask = llu(1) << alterationIndex;
-							SubnetworkEntry newEntry(subnetInfo);
-							bool lostSamples = newEntry.fixSamplesViaNode(neighbourIdx, singleColourBitmask, geneAlterations);
-							if (newEntry.numSamples() >= t && !nodesHash_buckets[newHash].count(*newEntry.samples)) {	// Number of patients is still high enough and the subgraph is not a duplicate
-								newEntry.isValid = true; // Need to do this because the base subnetwork's flag may have got marked as invalid in the 'if' below, before all neighbours got considered.
-								newEntry.nodes.push_back(neighbourIdx);
-								newEntry.nodeColourIdx.push_back(alterationIndex);
-								candidateSubnetworks[cycle].push_back(newEntry);
-								nodesHash_buckets[newHash].insert(*newEntry.samples);
-								if (!lostSamples && subnetInfo.isValid) {	// The newly identified subnetwork is a sample-wise-lossless extension, making the base subnetwork redundant
-									subnetInfo.isValid = false;
-									numContained++;
-								}
-							}
+		}
+	}
+
+	llu nodeColours(int nodeIdx) const {
+		return (seedSampleIdx < 0) ? networkColours[nodeIdx] : colourPlanes.coloursInSample(nodeIdx, seedSampleIdx) & edgeSupport.recurrentColours[nodeIdx];
+	}
+
+	// The seed is the lowest-index sample of a subnetwork or of one of its extensions only if at least t samples of its support are not lower than the seed. Otherwise the branch is cut.
+	bool canBeCanonical(const Mask & support) const {
+		return seedSampleIdx < 0 || countSetBitsFrom(support.bits, support.len, seedSampleIdx) >= t;
+	}
+
+	// Adds the parent colours followed by colourIdx, with the samples in 'extended', as a colouring of a node set of k + 1 nodes, unless one of its colourings from 'first' on has the same samples
+	void addColouring(int k, int first, const unsigned char * parentColours, int colourIdx) {
+		vector<int> & counts = colouringCounts[k];
+		vector<llu> & samples = colouringSamples[k];
+		for (int i = first; i < (int) counts.size(); i++) {
+			if (counts[i] == extended.getSize() && bitmaskKernels.equal(&samples[llu(i) * extended.len], extended.bits, extended.len))
+				return;
+		}
+		colourings[k].insert(colourings[k].end(), parentColours, parentColours + k);
+		colourings[k].push_back(colourIdx);
+		samples.insert(samples.end(), extended.bits, extended.bits + extended.len);
+		counts.push_back(extended.getSize());
+	}
+
+	void push(int k, int u, llu nodeAdjacency) {
+		nodes[k]			= comp -> nodeNames[u];
+		internalIdx[k]		= u;
+		adjacency[k]		= nodeAdjacency;
+		position[u]			= k;
+		for (llu rest = nodeAdjacency; rest; rest &= rest - 1)
+			adjacency[__builtin_ctzll(rest)] |= llu(1) << k;
+	}
+	void pop(int k) {
+		position[ internalIdx[k] ] = -1;
+		for (llu rest = adjacency[k]; rest; rest &= rest - 1)
+			adjacency[__builtin_ctzll(rest)] &= ~(llu(1) << k);
+	}
+
+	// Checks whether the current subnetwork of k nodes stays connected after removing position 'removed' and adding a node adjacent to 'nodeAdjacency' at position k
+	bool connectedWithout(int k, int removed, llu nodeAdjacency) {
+		llu remaining = ((llu(2) << k) - 1) & ~(llu(1) << removed);
+		llu reached = llu(1) << k;
+		llu frontier = reached;
+		while (frontier) {
+			llu next = 0;
+			for (llu rest = frontier; rest; rest &= rest - 1) {
+				int j = __builtin_ctzll(rest);
+				next |= (j == k) ? nodeAdjacency : adjacency[j] | (((nodeAdjacency >> j) & 1) << k);
+			}
+			frontier = next & remaining & ~reached;
+			reached |= frontier;
+		}
+		return reached == remaining;
+	}
+
+	// The new node is the canonical last node if every higher-index node of the extended subnetwork is a cut node
+	bool isCanonicalExtension(int k, int nodeIdx, llu nodeAdjacency) {
+		for (int j = 0; j < k; j++) {
+			if (nodes[j] > nodeIdx && connectedWithout(k, j, nodeAdjacency))
+				return false;
+		}
+		return true;
+	}
+
+	// Stores the colourings [begin, end) of the current node set of k nodes for which the seed is canonical, and recurses into its canonical children
+	void expand(int k, int begin, int end) {
+		const int len = extended.len;
+		const unsigned char * colours = colourings[k - 1].data();
+		const llu * samples = colouringSamples[k - 1].data();
+		const int * counts = colouringCounts[k - 1].data();
+		vector<char> & isContained = contained[k - 1];
+		isContained.assign(end - begin, 0);
+		vector<CanonicalExtension> & next = children[k - 1];
+		next.clear();
+		if (k < S) {
+			seenIdx++;
+			neighbours.clear();
+			for (int j = 0; j < k; j++) {
+				int u = internalIdx[j];
+				for (int nIdx = 0; nIdx < comp -> degree(u); nIdx++) {
+					int w = comp -> neighbours(u)[nIdx];
+					if (position[w] != -1) continue;
+					if (seen[w] != seenIdx) {
+						seen[w] = seenIdx;
+						neighbourAdjacency[w] = 0;
+						neighbours.push_back(w);
+					}
+					neighbourAdjacency[w] |= llu(1) << j;
+				}
+			}
+			colourings[k].clear();
+			colouringSamples[k].clear();
+			colouringCounts[k].clear();
+			for (int w : neighbours) {
+				int neighbourIdx = comp -> nodeNames[w];
+				bool canonical = isCanonicalExtension(k, neighbourIdx, neighbourAdjacency[w]);
+				int childBegin = colouringCounts[k].size();
+				for (int i = begin; i < end; i++) {
+					for (llu rest = this->nodeColours(neighbourIdx); rest; rest &= rest - 1) {
+						int colourIdx = __builtin_ctzll(rest);
+						extended.copyBits(&samples[llu(i) * len]);
+						extended.intersectWith(colourPlanes.plane(neighbourIdx, colourIdx));
+						if (extended.getSize() < t) continue;
+						if (extended.getSize() == counts[i])	// A sample-wise-lossless extension exists, making the colouring redundant
+							isContained[i - begin] = 1;
+						if (canonical && this->canBeCanonical(extended))
+							addColouring(k, childBegin, &colours[llu(i) * k], colourIdx);
+					}
+				}
+				if ((int) colouringCounts[k].size() > childBegin)
+					next.push_back(CanonicalExtension{ w, neighbourAdjacency[w], childBegin, (int) colouringCounts[k].size() });
+			}
+		}
+		for (int i = begin; i < end; i++) {
+			const llu * support = &samples[llu(i) * len];
+			int lowestSampleIdx = lowestSetBit(support, len);
+			if (seedSampleIdx >= 0 && lowestSampleIdx != seedSampleIdx) continue;
+			stats.numFound[k - 1]++;
+			if (isContained[i - begin]) {
+				stats.numContained++;
+				continue;
+			}
+			llu colourMask = 0;
+			for (int j = 0; j < k; j++)
+				colourMask |= llu(1) << colours[llu(i) * k + j];
+			int numColours = __builtin_popcountll(colourMask);
+			stats.colourCount[numColours]++;
+			if (numColours < minColours)
+				stats.numImproperlyColoured++;
+			else
+				(*levels)[k - 1].append(nodes.data(), &colours[llu(i) * k], support, counts[i], counts[i], lowestSampleIdx);
+		}
+		for (int i = 0; i < next.size(); i++) {
+			CanonicalExtension & child = next[i];
+			push(k, child.internalIdx, child.adjacency);
+			expand(k + 1, child.colouringBegin, child.colouringEnd);
+			pop(k);
+		}
+	}
+};
+
+/*
+	STAGE 3 over all seed samples, or over the recurrent network in canonical-seed mode. The work is split into units (a seed sample, or a range of roots of the recurrent network).
+	Threads grab units from a shared counter in batches, and the subnetworks stored by each unit are appended in unit order, so the result does not depend on the number of threads.
+	Whenever the levels hold more than memoryBudget bytes (if it is not 0) after a batch, all of them are spilled to files starting with spillPath. The levels are sealed at the end.
+*/
+template <class Mask>
+void enumerateCandidates(vector<CandidateLevel> & candidateSubnetworks, Subgraph *** CC, int * CC_count, int S, int t, int minColours, int threads, bool canonicalSeeds, llu memoryBudget, const string & spillPath, EnumerationStats & stats) {
+	const int numPatients	= samples.indices.size();
+	const int rootsPerUnit	= 16;
+	const int batchSize		= 4 * threads;
+	Subgraph * network = NULL;
+	int numUnits = numPatients;
+	if (canonicalSeeds) {
+		// The recurrent network keeps the nodes with at least one colour in t samples or more and the supported edges between them, which are the only ones that can be part of a candidate
+		vector<int> recurrentNodes;
+		for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+			if (edgeSupport.recurrentColours[nodeIdx])
+				recurrentNodes.push_back(nodeIdx);
+		}
+		vector<int> localIdx(G.V, -1);
+		network = new Subgraph(&G, recurrentNodes.data(), recurrentNodes.size(), localIdx, [&](int node, int k) { return edgeSupport.isSupported(node, k); });
+		numUnits = (network -> V + rootsPerUnit - 1) / rootsPerUnit;
+		fprintf(stderr, "Growing every subnetwork from its canonical seed only. The recurrent network has %d nodes.\n", network -> V);
+	}
+	vector< SeedEnumerator<Mask> * > enumerators(threads);
+	vector< vector<CandidateLevel> > batchLevels(batchSize);	// Subnetworks stored by each unit of the batch
+	for (int threadIdx = 0; threadIdx < threads; threadIdx++)
+		enumerators[threadIdx] = new SeedEnumerator<Mask>(S, t, minColours, numPatients, alterations.indices.size());
+	for (auto & levels : batchLevels) {
+		for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+			levels.push_back(CandidateLevel(sizeIdx + 1, candidateSubnetworks[sizeIdx].len));
+	}
+	int numSpills = 0;
+	llu spilledBytes = 0;
+	for (int batchStart = 0, lastProg = 0; batchStart < numUnits; batchStart += batchSize) {
+		int batchEnd = min(batchStart + batchSize, numUnits);
+		atomic<int> nextUnit(batchStart);
+		runInParallel(threads, [&](int threadIdx) {
+			SeedEnumerator<Mask> & enumerator = *enumerators[threadIdx];
+			for (int unitIdx = nextUnit++; unitIdx < batchEnd; unitIdx = nextUnit++) {
+				if (canonicalSeeds)
+					enumerator.enumerateNetwork(network, edgeSupport.recurrentColours, unitIdx * rootsPerUnit, min((unitIdx + 1) * rootsPerUnit, network -> V), batchLevels[unitIdx - batchStart]);
+				else
+					enumerator.enumerate(unitIdx, CC[unitIdx], CC_count[unitIdx], batchLevels[unitIdx - batchStart]);
+			}
+		});
+		for (int unitIdx = batchStart; unitIdx < batchEnd; unitIdx++) {
+			for (int sizeIdx = 0; sizeIdx < S; sizeIdx++) {
+				candidateSubnetworks[sizeIdx].append(batchLevels[unitIdx - batchStart][sizeIdx]);
+				batchLevels[unitIdx - batchStart][sizeIdx].clear();
+			}
+		}
+		if (memoryBudget) {
+			llu residentBytes = 0;
+			for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+				residentBytes += candidateSubnetworks[sizeIdx].residentBytes();
+			if (residentBytes > memoryBudget) {
+				for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+					candidateSubnetworks[sizeIdx].spill(spillPath + "_s" + to_string(sizeIdx + 1));
+				numSpills++;
+				spilledBytes += residentBytes;
+			}
+		}
+		int progress = 1000 * double(batchEnd) / double(numUnits);
+		if (progress > lastProg) {
+			fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
+			lastProg = progress;
+		}
+	}
+	stats = EnumerationStats(S, alterations.indices.size());
+	for (int threadIdx = 0; threadIdx < threads; threadIdx++) {
+		stats.add(enumerators[threadIdx] -> stats);
+		delete enumerators[threadIdx];
+	}
+	delete network;
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+		candidateSubnetworks[sizeIdx].seal(spillPath + "_s" + to_string(sizeIdx + 1));
+	if (numSpills)
+		fprintf(stderr, "\rSpilled the candidate subnetworks to disk %d times, releasing %.1lf MB of memory.\n", numSpills, double(spilledBytes) / (1 << 20));
+}
+
+/*
+	Builds the colour-plane index (global colourPlanes) from geneAlterations. Has to be called after the excluded genes got their colours removed.
+*/
+void buildColourPlanes() {
+	fprintf(stderr, "Building colour planes of the alteration profiles... ");
+	int timerStart = clock();
+	ColourPlanes & P	= colourPlanes;
+	P.numSamples		= samples.indices.size();
+	P.numColours		= alterations.indices.size();
+	P.len				= sampleMaskWords(P.numSamples);	// Planes are as wide as the sample bitmasks they get combined with
+	P.geneColours		= new llu [G.V];
+	P.planeOffset		= new llu [llu(G.V) * P.numColours];
+	P.colouredOffset	= new llu [G.V];
+	memset(P.planeOffset, 0, sizeof(P.planeOffset[0]) * G.V * P.numColours);
+	memset(P.colouredOffset, 0, sizeof(P.colouredOffset[0]) * G.V);
+	llu numPlanes = 1;	// Plane 0 is the shared all-zero plane
+	llu numPairs = 0;
+	for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+		P.geneColours[nodeIdx] = 0;
+		for (auto it : geneAlterations[nodeIdx])
+			P.geneColours[nodeIdx] |= it.second;
+		if (P.geneColours[nodeIdx]) {
+			P.colouredOffset[nodeIdx] = numPlanes++ * P.len;
+			numPairs += __builtin_popcountll(P.geneColours[nodeIdx]);
+			for (llu rest = P.geneColours[nodeIdx]; rest; rest &= rest - 1)
+				P.planeOffset[llu(nodeIdx) * P.numColours + __builtin_ctzll(rest)] = numPlanes++ * P.len;
+		}
+	}
+	P.numPlanes = numPlanes;
+	P.bits = new llu [numPlanes * P.len];
+	memset(P.bits, 0, sizeof(P.bits[0]) * numPlanes * P.len);
+	for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+		for (auto it : geneAlterations[nodeIdx]) {
+			int sampleIdx = it.first;
+			llu sampleBit = llu(1) << (sampleIdx % 64);
+			P.bits[ P.colouredOffset[nodeIdx] + sampleIdx / 64 ] |= sampleBit;
+			for (llu rest = it.second; rest; rest &= rest - 1)
+				P.bits[ P.planeOffset[llu(nodeIdx) * P.numColours + __builtin_ctzll(rest)] + sampleIdx / 64 ] |= sampleBit;
+		}
+	}
+	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	fprintf(stderr, "\tThere are %llu (gene, alteration) pairs, using %.1lf MB.\n", numPairs, double(numPlanes * P.len * sizeof(llu)) / (1 << 20));
+}
+
+/*
+	Binary snapshot of the preprocessed input: the network in CSR form with its chromosome arms, the interned sample, gene and alteration names, the subnetwork seeds and the colour planes.
+	The file starts with a SnapshotHeader, followed by the sections in the order they are written below. Every section starts at a multiple of 8 bytes, so that loadSnapshot can point the arrays straight into the mapped file.
+	Snapshots are written after -c and -x have been applied, and are tied to the snapshotVersion below.
+*/
+const char snapshotMagic[8] = {'C', 'D', 'C', 'A', 'P', 'S', 'N', 'P'};
+const int snapshotVersion = 1;
+
+struct SnapshotHeader {
+	char magic[8];
+	int version;
+	int V;
+	llu E;
+	int numSamples;
+	int numGenes;
+	int numAlterations;
+	int len;				// Number of 64-bit words in a colour plane
+	llu numPlanes;
+	llu numSeeds;
+	llu namesBytes;			// Total size of the NUL-terminated names, in the order nodes, samples, genes, alterations
+};
+
+void writeSnapshotSection(FILE * fout, const void * data, llu bytes) {
+	static const char padding[8] = {};
+	fwrite(data, 1, bytes, fout);
+	fwrite(padding, 1, (8 - bytes % 8) % 8, fout);
+}
+
+llu snapshotSectionSize(llu bytes) { return (bytes + 7) / 8 * 8; }
+
+/*
+	Writes the snapshot of the current input (the --build-snapshot option). Has to be called after buildColourPlanes.
+*/
+void writeSnapshot(const char * filename) {
+	fprintf(stderr, "Writing the snapshot... ");
+	int timerStart = clock();
+	FILE * fout = fopen(filename, "wb");
+	if (!fout) {
+		fprintf(stderr, "\n< Error > Cannot create file '%s'.\n", filename);
+		exit(0);
+	}
+	const ColourPlanes & P = colourPlanes;
+	string names;
+	for (int i = 0; i < G.V; i++) names.append(G.nodeNames[i].c_str(), G.nodeNames[i].size() + 1);
+	for (Entry * entry : {&samples, &genes, &alterations}) {
+		for (llu i = 0; i < entry -> indices.size(); i++)
+			names.append(entry -> names[i].c_str(), entry -> names[i].size() + 1);
+	}
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+	header.version			= snapshotVersion;
+	header.V				= G.V;
+	header.E				= G.E;
+	header.numSamples		= samples.indices.size();
+	header.numGenes			= genes.indices.size();
+	header.numAlterations	= alterations.indices.size();
+	header.len				= P.len;
+	header.numPlanes		= P.numPlanes;
+	header.numSeeds			= subnetworkSeeds.size();
+	header.namesBytes		= names.size();
+	writeSnapshotSection(fout, &header, sizeof(header));
+	writeSnapshotSection(fout, G.adjStart, sizeof(G.adjStart[0]) * (G.V + 1));
+	writeSnapshotSection(fout, G.adj, sizeof(G.adj[0]) * G.E);
+	writeSnapshotSection(fout, G.chrArm, sizeof(G.chrArm[0]) * G.V);
+	writeSnapshotSection(fout, subnetworkSeeds.data(), sizeof(subnetworkSeeds[0]) * subnetworkSeeds.size());
+	writeSnapshotSection(fout, P.geneColours, sizeof(P.geneColours[0]) * G.V);
+	writeSnapshotSection(fout, P.planeOffset, sizeof(P.planeOffset[0]) * G.V * P.numColours);
+	writeSnapshotSection(fout, P.colouredOffset, sizeof(P.colouredOffset[0]) * G.V);
+	writeSnapshotSection(fout, P.bits, sizeof(P.bits[0]) * P.numPlanes * P.len);
+	writeSnapshotSection(fout, names.data(), names.size());
+	if (ferror(fout) | fclose(fout)) {
+		fprintf(stderr, "\n< Error > Cannot write file '%s'.\n", filename);
+		exit(0);
+	}
+	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+}
+
+/*
+	Maps a snapshot written by writeSnapshot (the --snapshot option) in place of reading the -n, -l, -c and -x inputs.
+	The adjacency, chromosome arms and colour planes are used from the mapping without copying; only the names and their indices are rebuilt. G.nodeIndices is left empty, as it is only needed while reading text inputs.
+*/
+void loadSnapshot(const char * filename) {
+	fprintf(stderr, "Mapping the snapshot... ");
+	int timerStart = clock();
+	int fd = open(filename, O_RDONLY);
+	struct stat fileInfo;
+	if (fd < 0 || fstat(fd, &fileInfo) < 0) {
+		fprintf(stderr, "\n< Error > Cannot open file '%s'. Please make sure the file exists.\n", filename);
+		exit(0);
+	}
+	llu fileSize = fileInfo.st_size;
+	if (fileSize < sizeof(SnapshotHeader)) {
+		fprintf(stderr, "\n< Error > File '%s' is not a snapshot. Please rebuild it with --build-snapshot.\n", filename);
+		exit(0);
+	}
+	const char * data = (const char *) mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		fprintf(stderr, "\n< Error > Cannot map file '%s' into memory.\n", filename);
+		exit(0);
+	}
+	SnapshotHeader header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, snapshotMagic, sizeof(header.magic)) != 0 || header.version != snapshotVersion) {
+		fprintf(stderr, "\n< Error > File '%s' is not a snapshot of version %d. Please rebuild it with --build-snapshot.\n", filename, snapshotVersion);
+		exit(0);
+	}
+	llu numColours = header.numAlterations;
+	llu expectedSize = snapshotSectionSize(sizeof(header))
+		+ snapshotSectionSize(sizeof(llu) * (header.V + 1))
+		+ snapshotSectionSize(sizeof(int) * header.E)
+		+ snapshotSectionSize(sizeof(int) * header.V)
+		+ snapshotSectionSize(sizeof(pair<int, int>) * header.numSeeds)
+		+ snapshotSectionSize(sizeof(llu) * header.V)
+		+ snapshotSectionSize(sizeof(llu) * header.V * numColours)
+		+ snapshotSectionSize(sizeof(llu) * header.V)
+		+ snapshotSectionSize(sizeof(llu) * header.numPlanes * header.len)
+		+ snapshotSectionSize(header.namesBytes);
+	if (fileSize != expectedSize) {
+		fprintf(stderr, "\n< Error > Snapshot '%s' is truncated or corrupted.\n", filename);
+		exit(0);
+	}
+	const char * cursor = data;
+	auto takeSection = [&cursor](llu bytes) {
+		const char * section = cursor;
+		cursor += snapshotSectionSize(bytes);
+		return (void *) section;
+	};
+	takeSection(sizeof(header));
+	G.V				= header.V;
+	G.E				= header.E;
+	G.adjStart		= (llu *) takeSection(sizeof(llu) * (G.V + 1));
+	G.adj			= (int *) takeSection(sizeof(int) * G.E);
+	G.chrArm		= (int *) takeSection(sizeof(int) * G.V);
+	const pair<int, int> * seeds = (const pair<int, int> *) takeSection(sizeof(pair<int, int>) * header.numSeeds);
+	subnetworkSeeds.assign(seeds, seeds + header.numSeeds);
+	ColourPlanes & P	= colourPlanes;
+	P.numSamples		= header.numSamples;
+	P.numColours		= header.numAlterations;
+	P.len				= header.len;
+	P.numPlanes			= header.numPlanes;
+	P.geneColours		= (llu *) takeSection(sizeof(llu) * G.V);
+	P.planeOffset		= (llu *) takeSection(sizeof(llu) * G.V * numColours);
+	P.colouredOffset	= (llu *) takeSection(sizeof(llu) * G.V);
+	P.bits				= (llu *) takeSection(sizeof(llu) * P.numPlanes * P.len);
+	const char * name	= (const char *) takeSection(header.namesBytes);
+	G.nodeNames = new string [G.V];
+	for (int i = 0; i < G.V; i++) {
+		G.nodeNames[i] = name;
+		name += G.nodeNames[i].size() + 1;
+	}
+	int entrySizes[3] = {header.numSamples, header.numGenes, header.numAlterations};
+	Entry * entries[3] = {&samples, &genes, &alterations};
+	for (int k = 0; k < 3; k++) {
+		entries[k] -> names = new string [ entrySizes[k] ];
+		for (int i = 0; i < entrySizes[k]; i++) {
+			entries[k] -> names[i] = name;
+			entries[k] -> indices[ entries[k] -> names[i] ] = i;
+			name += entries[k] -> names[i].size() + 1;
+		}
+	}
+	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	fprintf(stderr, "\tInput network contains %d nodes and %llu undirected edges.\n", G.V, G.E / 2);
+	fprintf( stderr, "\tThere are %lu samples, with a total of %lu genes, harboring %lu different alterations.\n", samples.indices.size(), genes.indices.size(), alterations.indices.size() );
+	fprintf(stderr, "\tThere are %lu possible subnetwork seeds.\n", subnetworkSeeds.size());
+}
+
+/*
+	Builds the edge support index (global edgeSupport) for the recurrence threshold t. Nodes are split among the threads, first for counting the supported pairs of their edges and then for filling them in.
+*/
+void buildEdgeSupportIndex(int t, int threads) {
+	fprintf(stderr, "Building the edge support index... ");
+	int timerStart = clock();
+	EdgeSupportIndex & I	= edgeSupport;
+	const ColourPlanes & P	= colourPlanes;
+	I.len				= P.len;
+	I.recurrentColours	= new llu [G.V];
+	for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+		I.recurrentColours[nodeIdx] = 0;
+		for (llu rest = P.geneColours[nodeIdx]; rest; rest &= rest - 1) {
+			int colourIdx = __builtin_ctzll(rest);
+			if (countSetBitsFrom(P.plane(nodeIdx, colourIdx), P.len, 0) >= t)
+				I.recurrentColours[nodeIdx] |= llu(1) << colourIdx;
+		}
+	}
+	llu numEdges = G.E;
+	I.pairStart = new llu [numEdges + 1];
+	memset(I.pairStart, 0, sizeof(I.pairStart[0]) * (numEdges + 1));
+	I.pairBits = NULL;
+	// Pass 0 counts the supported pairs of every edge into pairStart[e + 1], pass 1 writes them
+	for (int pass = 0; pass < 2; pass++) {
+		runInParallel(threads, [&](int threadIdx) {
+			vector<llu> pairSamples(P.len);
+			for (int nodeIdx = threadIdx; nodeIdx < G.V; nodeIdx += threads) {
+				if (!I.recurrentColours[nodeIdx]) continue;
+				for (int k = 0; k < G.degree(nodeIdx); k++) {
+					int neighbour = G.neighbours(nodeIdx)[k];
+					llu e = I.edgeId(nodeIdx, k);
+					llu numPairs = 0;
+					for (llu rest = I.recurrentColours[nodeIdx]; rest; rest &= rest - 1) {
+						int colourIdx = __builtin_ctzll(rest);
+						for (llu restN = I.recurrentColours[neighbour]; restN; restN &= restN - 1) {
+							int neighbourColourIdx = __builtin_ctzll(restN);
+							memcpy(pairSamples.data(), P.plane(nodeIdx, colourIdx), sizeof(llu) * P.len);
+							if (bitmaskKernels.andCount(pairSamples.data(), P.plane(neighbour, neighbourColourIdx), P.len) < t) continue;
+							if (pass == 1)
+								memcpy(I.pairBits + (I.pairStart[e] + numPairs) * P.len, pairSamples.data(), sizeof(llu) * P.len);
+							numPairs++;
 						}
 					}
+					if (pass == 0)
+						I.pairStart[e + 1] = numPairs;
+				}
+			}
+		});
+		if (pass == 0) {
+			for (llu e = 0; e < numEdges; e++)
+				I.pairStart[e + 1] += I.pairStart[e];
+			I.pairBits = new llu [I.pairStart[numEdges] * P.len];
+		}
+	}
+	llu numSupportedEdges = 0;
+	for (llu e = 0; e < numEdges; e++)
+		numSupportedEdges += I.pairStart[e + 1] > I.pairStart[e];
+	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	fprintf(stderr, "%llu of the %llu undirected edges join coloured nodes in at least %d patients, with %llu coloured pairs in total.\n", numSupportedEdges / 2, numEdges / 2, t, I.pairStart[numEdges] / 2);
+}
+
+/*
+	Coverage lists of the (sample, node) pairs of the subnetwork seeds, in CSR form. These are exactly the pairs in which the node is coloured, so seeds with several alterations share their pair.
+	Pairs are numbered node after node, following the coloured plane of the node: pair (s, g) is wordPair[g * len + s / 64] plus the number of samples below s in word s / 64 of coloured(g).
+	The proper subgraphs that cover pair p, i.e. contain its node and have its sample, are cover[coverStart[p]] .. cover[coverStart[p + 1] - 1], in increasing order.
+*/
+struct NodeCoverIndex {
+	int len;
+	vector<llu> wordPair;		// wordPair[g * len + w] = first pair of gene g in word w
+	vector<llu> seedPair;		// seedPair[k] = pair of subnetworkSeeds[k]
+	vector<llu> coverStart;
+	vector<int> cover;
+
+	llu pairOf(int sampleIdx, int nodeIdx) const {
+		llu below = colourPlanes.coloured(nodeIdx)[sampleIdx / 64] & ((llu(1) << (sampleIdx % 64)) - 1);
+		return wordPair[llu(nodeIdx) * len + sampleIdx / 64] + __builtin_popcountll(below);
+	}
+
+	llu coverSize(llu pair) const { return coverStart[pair + 1] - coverStart[pair]; }
+
+	const int * coverOf(llu pair) const { return cover.data() + coverStart[pair]; }
+
+	// Renumbers the subgraphs in the coverage lists to columnOf[i], and drops those whose column is -1
+	void renumber(const vector<int> & columnOf) {
+		llu numPairs = coverStart.size() - 1;
+		llu position = 0;
+		for (llu p = 0; p < numPairs; p++) {
+			llu start = coverStart[p];
+			coverStart[p] = position;
+			for (llu e = start; e < coverStart[p + 1]; e++) {
+				if (columnOf[ cover[e] ] >= 0)
+					cover[position++] = columnOf[ cover[e] ];
+			}
+		}
+		coverStart[numPairs] = position;
+		cover.resize(position);
+	}
+
+	// Calls visit(p) for every pair p covered by a subgraph, node after node
+	template <class Visit>
+	void forEachPair(const int * nodes, int size, const llu * sampleBits, Visit visit) const {
+		for (int j = 0; j < size; j++) {
+			const llu * coloured = colourPlanes.coloured(nodes[j]);
+			const llu * firstPair = &wordPair[llu(nodes[j]) * len];
+			for (int w = 0; w < len; w++) {
+				for (llu rest = sampleBits[w] & coloured[w]; rest; rest &= rest - 1)
+					visit(firstPair[w] + __builtin_popcountll(coloured[w] & ((rest & -rest) - 1)));
+			}
+		}
+	}
+
+	// Numbers the pairs and finds the pair of every seed, without the coverage lists. Returns the number of pairs
+	llu numberPairs() {
+		len = colourPlanes.len;
+		wordPair.resize(llu(G.V) * len);
+		llu numPairs = 0;
+		for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+			const llu * coloured = colourPlanes.coloured(nodeIdx);
+			for (int w = 0; w < len; w++) {
+				wordPair[llu(nodeIdx) * len + w] = numPairs;
+				numPairs += __builtin_popcountll(coloured[w]);
+			}
+		}
+		seedPair.resize(subnetworkSeeds.size());
+		for (llu k = 0; k < subnetworkSeeds.size(); k++)
+			seedPair[k] = pairOf(subnetworkSeeds[k].first, subnetworkSeeds[k].second);
+		return numPairs;
+	}
+
+	/*
+		Counts the covering subgraphs of every pair, then fills them in. Only the samples of a subgraph in which a node is coloured are visited for that node.
+		Every thread takes a contiguous range of the proper subgraphs, and counts into its own array in the first pass. Turned into per-thread offsets, these counts let the threads fill their lists without synchronisation and in increasing order.
+	*/
+	void build(vector<CandidateLevel> & levels, int threads) {
+		llu numPairs = numberPairs();
+		vector<llu> levelStart(levels.size() + 1, 0);
+		for (llu sizeIdx = 0; sizeIdx < levels.size(); sizeIdx++)
+			levelStart[sizeIdx + 1] = levelStart[sizeIdx] + levels[sizeIdx].count();
+		llu numSubgraphs = levelStart[levels.size()];
+		vector< vector<llu> > cursor(threads);	// Counts of the thread in the first pass, then the positions at which it writes
+		coverStart.assign(numPairs + 1, 0);
+		for (int pass = 0; pass < 2; pass++) {
+			runInParallel(threads, [&](int threadIdx) {
+				vector<llu> & threadCursor = cursor[threadIdx];
+				if (pass == 0)
+					threadCursor.assign(numPairs, 0);
+				llu first = numSubgraphs * threadIdx / threads;
+				llu last = numSubgraphs * (threadIdx + 1) / threads;
+				for (llu sizeIdx = 0; sizeIdx < levels.size(); sizeIdx++) {
+					CandidateLevel & level = levels[sizeIdx];
+					for (llu i = max(first, levelStart[sizeIdx]); i < min(last, levelStart[sizeIdx + 1]); i++) {
+						llu local = i - levelStart[sizeIdx];
+						if (pass == 0)
+							forEachPair(level.nodesOf(local), level.size, level.samplesOf(local), [&](llu p) { threadCursor[p]++; });
+						else
+							forEachPair(level.nodesOf(local), level.size, level.samplesOf(local), [&](llu p) { cover[ threadCursor[p]++ ] = i; });
+					}
+				}
+			});
+			if (pass == 0) {
+				for (llu p = 0; p < numPairs; p++) {
+					llu position = coverStart[p];
+					for (int threadIdx = 0; threadIdx < threads; threadIdx++) {
+						llu count = cursor[threadIdx][p];
+						cursor[threadIdx][p] = position;
+						position += count;
+					}
+					coverStart[p + 1] = position;
+				}
+				cover.resize(coverStart[numPairs]);
+			}
+		}
+	}
+};
+
+/*
+	Presolve of the ILP, which removes the subgraphs whose coverage is already given by another subgraph.
+	The pairs covered by a subgraph are, for every node, the samples of the subgraph in which the node is coloured, so coverage is compared node by node on these bitmasks.
+	Level 1 keeps only the first of every group of subgraphs that cover exactly the same pairs, found by the number and a hash of their pairs. Level 2 also removes the subgraphs that cover a strict subset of the pairs of another one, which has to be in the coverage list of the rarest pair of the subgraph.
+	Every removed subgraph leaves one that covers all of its pairs, so the optimum does not change.
+	Returns the proper subgraph of every remaining X column, and renumbers the node covers to these columns.
+*/
+vector<int> presolveCandidates(NodeCoverIndex & nodeCover, vector<CandidateLevel> & levels, int presolveLevel, int threads) {
+	clock_t timerStart = clock();
+	vector<llu> levelStart(levels.size() + 1, 0);
+	for (llu sizeIdx = 0; sizeIdx < levels.size(); sizeIdx++)
+		levelStart[sizeIdx + 1] = levelStart[sizeIdx] + levels[sizeIdx].count();
+	llu numSubgraphs = levelStart[levels.size()];
+	vector<unsigned char> levelOf(numSubgraphs);
+	for (llu sizeIdx = 0; sizeIdx < levels.size(); sizeIdx++)
+		fill(levelOf.begin() + levelStart[sizeIdx], levelOf.begin() + levelStart[sizeIdx + 1], sizeIdx);
+	int len = colourPlanes.len;
+
+	// Whether subgraph b covers all pairs of subgraph a
+	auto coversAll = [&](llu b, llu a) {
+		const CandidateLevel & A = levels[ levelOf[a] ];
+		const CandidateLevel & B = levels[ levelOf[b] ];
+		const int * nodesA = A.nodesOf(a - levelStart[ levelOf[a] ]);
+		const int * nodesB = B.nodesOf(b - levelStart[ levelOf[b] ]);
+		const llu * samplesA = A.samplesOf(a - levelStart[ levelOf[a] ]);
+		const llu * samplesB = B.samplesOf(b - levelStart[ levelOf[b] ]);
+		for (int j = 0; j < A.size; j++) {
+			const llu * coloured = colourPlanes.coloured(nodesA[j]);
+			bool inB = find(nodesB, nodesB + B.size, nodesA[j]) != nodesB + B.size;
+			for (int w = 0; w < len; w++) {
+				llu pairs = samplesA[w] & coloured[w];
+				if (pairs && (!inB || (pairs & ~samplesB[w])))
+					return false;
+			}
+		}
+		return true;
+	};
+
+	// Number of pairs, hash of the pairs and a 64-bit signature of the nodes with pairs of every subgraph
+	vector<int> coverCount(numSubgraphs);
+	vector<llu> coverHash(numSubgraphs);
+	vector<llu> nodeSignature(numSubgraphs);
+	runInParallel(threads, [&](int threadIdx) {
+		for (llu i = numSubgraphs * threadIdx / threads; i < numSubgraphs * (threadIdx + 1) / threads; i++) {
+			const CandidateLevel & level = levels[ levelOf[i] ];
+			const int * nodes = level.nodesOf(i - levelStart[ levelOf[i] ]);
+			const llu * sampleBits = level.samplesOf(i - levelStart[ levelOf[i] ]);
+			int count = 0;
+			llu hash = 0, signature = 0;
+			for (int j = 0; j < level.size; j++) {
+				const llu * coloured = colourPlanes.coloured(nodes[j]);
+				llu nodeHash = (HASH_SEED + nodes[j]) * HASH_FACTOR;
+				int nodeCount = 0;
+				for (int w = 0; w < len; w++) {
+					llu pairs = sampleBits[w] & coloured[w];
+					nodeCount += __builtin_popcountll(pairs);
+					nodeHash = (nodeHash ^ pairs) * HASH_FACTOR;
+				}
+				if (nodeCount) {
+					count += nodeCount;
+					hash += nodeHash ^ (nodeHash >> 29);
+					signature |= llu(1) << ( ((llu(nodes[j]) * HASH_FACTOR) >> 58) );
+				}
+			}
+			coverCount[i] = count;
+			coverHash[i] = hash;
+			nodeSignature[i] = signature;
+		}
+	});
+
+	vector<int> order(numSubgraphs);
+	for (llu i = 0; i < numSubgraphs; i++) order[i] = i;
+	sort(order.begin(), order.end(), [&](int a, int b) {
+		if (coverCount[a] != coverCount[b]) return coverCount[a] < coverCount[b];
+		if (coverHash[a] != coverHash[b]) return coverHash[a] < coverHash[b];
+		return a < b;
+	});
+	vector<char> removed(numSubgraphs, 0);
+	llu numIdentical = 0;
+	for (llu start = 0, end; start < numSubgraphs; start = end) {
+		for (end = start + 1; end < numSubgraphs && coverCount[ order[end] ] == coverCount[ order[start] ] && coverHash[ order[end] ] == coverHash[ order[start] ]; end++);
+		for (llu k = start; k < end; k++) {
+			for (llu l = k + 1; l < end && !removed[ order[k] ]; l++) {
+				if (!removed[ order[l] ] && coversAll(order[k], order[l])) {
+					removed[ order[l] ] = 1;
+					numIdentical++;
+				}
+			}
+		}
+	}
+	vector<llu>().swap(coverHash);
+	vector<int>().swap(order);
+
+	llu numDominated = 0;
+	if (presolveLevel >= 2) {
+		vector<char> dominated(numSubgraphs, 0);
+		runInParallel(threads, [&](int threadIdx) {
+			for (llu i = numSubgraphs * threadIdx / threads; i < numSubgraphs * (threadIdx + 1) / threads; i++) {
+				if (removed[i]) continue;
+				const CandidateLevel & level = levels[ levelOf[i] ];
+				llu rarestPair = 0, rarestSize = ULLONG_MAX;
+				nodeCover.forEachPair(level.nodesOf(i - levelStart[ levelOf[i] ]), level.size, level.samplesOf(i - levelStart[ levelOf[i] ]), [&](llu p) {
+					if (nodeCover.coverSize(p) < rarestSize) {
+						rarestPair = p;
+						rarestSize = nodeCover.coverSize(p);
+					}
+				});
+				const int * covering = nodeCover.coverOf(rarestPair);
+				for (llu k = 0; k < rarestSize && !dominated[i]; k++) {
+					llu other = covering[k];
+					dominated[i] = !removed[other] && coverCount[other] > coverCount[i] && (nodeSignature[i] & ~nodeSignature[other]) == 0 && coversAll(other, i);
 				}
 			}
+		});
+		for (llu i = 0; i < numSubgraphs; i++) {
+			numDominated += dominated[i];
+			removed[i] |= dominated[i];
+		}
+	}
+
+	vector<int> columnOf(numSubgraphs, -1);
+	vector<int> columnSubgraph;
+	for (llu i = 0; i < numSubgraphs; i++) {
+		if (!removed[i]) {
+			columnOf[i] = columnSubgraph.size();
+			columnSubgraph.push_back(i);
+		}
+	}
+	nodeCover.renumber(columnOf);
+	fprintf(stderr, "\tPresolve removed %llu of the %llu subgraphs: %llu with the same coverage as another one, and %llu covering a strict subset of another one. (%.2lf seconds)\n", numIdentical + numDominated, numSubgraphs, numIdentical, numDominated, double(clock() - timerStart) / CLOCKS_PER_SEC);
+	return columnSubgraph;
+}
+
+/*
+	Interface of the MIP backends, against which the selection ILP is built once. Columns are binary, unless the model was relaxed, and numbered in the order they are added. The objective is maximized.
+*/
+struct MipSolver {
+	virtual ~MipSolver() {}
+	virtual void addBinaryColumns(int count, const double * objective) = 0;
+	// Adds columns with nonzeros in the existing rows, in CSC form like the rows of addRows
+	virtual void addBinaryColumns(int count, const double * objective, const int * columnStart, int numNonzeros, const int * rows, const double * values) = 0;
+	// Adds the rows in CSR form, row r having the nonzeros rowStart[r] .. rowStart[r + 1] - 1 (numNonzeros for the last row), with the same sense ('G' or 'L') and right-hand side
+	virtual void addRows(int numRows, const int * rowStart, int numNonzeros, const int * columns, const double * values, char sense, double rhs) = 0;
+	virtual void writeModel(const char * path) = 0;
+	virtual void setStart(int count, const int * columns, const double * values) = 0;
+	virtual void changeRhs(int row, char sense, double rhs) = 0;
+	// Returns whether a solution was found, in which case it is written to solutionPath (unless it is NULL) and the values of columns 0 .. count - 1 are stored in values. Backends with a fixed number of threads (fixedMipSolverThreads) ignore 'threads'.
+	virtual bool solve(int threads, int seconds, const char * solutionPath, int count, double * values) = 0;
+	// Makes every column continuous in [0, 1], also the ones added later
+	virtual void relax() = 0;
+	// Solves the relaxed model. Returns whether an optimum was found, in which case its objective and the duals of rows 0 .. numRows - 1 are stored
+	virtual bool solveRelaxation(int threads, int seconds, int numRows, double * duals, double & objective) = 0;
+	// Removes all columns and rows, so that another model can be built with the same environment
+	virtual void clear() = 0;
+};
+
+#ifdef USE_CPLEX
+/*
+	Stops the program with the CPLEX message if a callable library routine failed.
+*/
+void checkCplex(CPXCENVptr env, int status, const char * action) {
+	if (status == 0)
+		return;
+	char message[CPXMESSAGEBUFSIZE];
+	if (CPXgeterrorstring(env, status, message) == NULL)
+		sprintf(message, "CPLEX error %d.\n", status);
+	fprintf(stderr, "\n< Error > Could not %s: %s", action, message);
+	exit(0);
+}
+
+/*
+	CPLEX backend, through the callable library.
+*/
+struct CplexSolver : MipSolver {
+	CPXENVptr env;
+	CPXLPptr lp;
+	bool relaxed;
+
+	CplexSolver(bool screenOutput) : relaxed(false) {
+		int status = 0;
+		env = CPXopenCPLEX(&status);
+		if (env == NULL) {
+			fprintf(stderr, "\n< Error > Could not open the CPLEX environment (error %d). Exiting program.\n", status);
+			exit(0);
+		}
+		checkCplex(env, CPXsetintparam(env, CPXPARAM_ScreenOutput, screenOutput ? CPX_ON : CPX_OFF), "set the CPLEX log");
+		createProblem();
+	}
+
+	void createProblem() {
+		int status = 0;
+		lp = CPXcreateprob(env, &status, "mcsc");
+		checkCplex(env, status, "create the ILP model");
+		checkCplex(env, CPXchgobjsen(env, lp, CPX_MAX), "set the objective sense");
+	}
+
+	~CplexSolver() {
+		CPXfreeprob(env, &lp);
+		CPXcloseCPLEX(&env);
+	}
+
+	void addBinaryColumns(int count, const double * objective) {
+		vector<double> upper(count, 1);
+		vector<char> binary(count, 'B');
+		checkCplex(env, CPXnewcols(env, lp, count, objective, NULL, upper.data(), relaxed ? NULL : binary.data(), NULL), "add the variables");
+	}
+
+	void addBinaryColumns(int count, const double * objective, const int * columnStart, int numNonzeros, const int * rows, const double * values) {
+		vector<double> upper(count, 1);
+		checkCplex(env, CPXaddcols(env, lp, count, numNonzeros, objective, columnStart, rows, values, NULL, upper.data(), NULL), "add the variables");
+		if (relaxed)
+			return;
+		vector<int> columns(count);
+		for (int i = 0; i < count; i++)
+			columns[i] = CPXgetnumcols(env, lp) - count + i;
+		vector<char> binary(count, 'B');
+		checkCplex(env, CPXchgctype(env, lp, count, columns.data(), binary.data()), "add the variables");
+	}
+
+	void addRows(int numRows, const int * rowStart, int numNonzeros, const int * columns, const double * values, char sense, double rhs) {
+		vector<char> senses(numRows, sense);
+		vector<double> rhsValues(numRows, rhs);
+		checkCplex(env, CPXaddrows(env, lp, 0, numRows, numNonzeros, rhsValues.data(), senses.data(), rowStart, columns, values, NULL, NULL), "add the constraints");
+	}
+
+	void writeModel(const char * path) {
+		checkCplex(env, CPXwriteprob(env, lp, path, NULL), "write the ILP model");
+	}
+
+	void setStart(int count, const int * columns, const double * values) {
+		int startBegin = 0, effort = CPX_MIPSTART_AUTO;
+		checkCplex(env, CPXaddmipstarts(env, lp, 1, count, &startBegin, columns, values, &effort, NULL), "add the MIP start");
+	}
+
+	void changeRhs(int row, char sense, double rhs) {
+		checkCplex(env, CPXchgrhs(env, lp, 1, &row, &rhs), "change the right-hand side");
+	}
+
+	bool solve(int threads, int seconds, const char * solutionPath, int count, double * values) {
+		checkCplex(env, CPXsetintparam(env, CPXPARAM_Threads, threads), "set the number of threads");
+		checkCplex(env, CPXsetdblparam(env, CPXPARAM_TimeLimit, seconds), "set the time limit");
+		checkCplex(env, CPXmipopt(env, lp), "solve the ILP model");
+		return (solutionPath == NULL || CPXsolwrite(env, lp, solutionPath) == 0) && CPXgetx(env, lp, values, 0, count - 1) == 0;
+	}
+
+	void relax() {
+		checkCplex(env, CPXchgprobtype(env, lp, CPXPROB_LP), "relax the ILP model");
+		relaxed = true;
+	}
+
+	bool solveRelaxation(int threads, int seconds, int numRows, double * duals, double & objective) {
+		checkCplex(env, CPXsetintparam(env, CPXPARAM_Threads, threads), "set the number of threads");
+		checkCplex(env, CPXsetdblparam(env, CPXPARAM_TimeLimit, seconds), "set the time limit");
+		checkCplex(env, CPXlpopt(env, lp), "solve the LP relaxation");
+		return CPXgetstat(env, lp) == CPX_STAT_OPTIMAL && CPXgetobjval(env, lp, &objective) == 0 && CPXgetpi(env, lp, duals, 0, numRows - 1) == 0;
+	}
+
+	void clear() {
+		CPXfreeprob(env, &lp);
+		createProblem();
+		relaxed = false;
+	}
+};
+#endif
+
+#ifdef USE_HIGHS
+/*
+	HiGHS backend. Rows are stored as ranges, so 'G' rows get an infinite upper bound and 'L' rows an infinite lower bound.
+	HiGHS runs its solves on a global task scheduler, which is sized by the first solve and rejects solves that ask for another number of threads. Every instance therefore uses the number of threads set once by setMipSolverThreads, before the first one is created.
+*/
+struct HighsSolver : MipSolver {
+	static int threads;
+	Highs highs;
+	bool relaxed;
+
+	HighsSolver(bool screenOutput) : relaxed(false) {
+		highs.setOptionValue("output_flag", screenOutput);
+		highs.setOptionValue("threads", HighsInt(threads));
+		highs.changeObjectiveSense(ObjSense::kMaximize);
+	}
+
+	void check(HighsStatus status, const char * action) {
+		if (status == HighsStatus::kError) {
+			fprintf(stderr, "\n< Error > Could not %s with HiGHS. Exiting program.\n", action);
+			exit(0);
+		}
+	}
+
+	void addBinaryColumns(int count, const double * objective) {
+		int first = highs.getNumCol();
+		vector<double> zeros(count, 0), ones(count, 1);
+		check(highs.addCols(count, objective ? objective : zeros.data(), zeros.data(), ones.data(), 0, NULL, NULL, NULL), "add the variables");
+		if (relaxed)
+			return;
+		vector<HighsVarType> integer(count, HighsVarType::kInteger);
+		check(highs.changeColsIntegrality(first, first + count - 1, integer.data()), "add the variables");
+	}
+
+	void addBinaryColumns(int count, const double * objective, const int * columnStart, int numNonzeros, const int * rows, const double * values) {
+		int first = highs.getNumCol();
+		vector<double> zeros(count, 0), ones(count, 1);
+		vector<HighsInt> starts(columnStart, columnStart + count);
+		vector<HighsInt> indices(rows, rows + numNonzeros);
+		check(highs.addCols(count, objective ? objective : zeros.data(), zeros.data(), ones.data(), numNonzeros, starts.data(), indices.data(), values), "add the variables");
+		if (relaxed)
+			return;
+		vector<HighsVarType> integer(count, HighsVarType::kInteger);
+		check(highs.changeColsIntegrality(first, first + count - 1, integer.data()), "add the variables");
+	}
+
+	void addRows(int numRows, const int * rowStart, int numNonzeros, const int * columns, const double * values, char sense, double rhs) {
+		vector<double> lower(numRows, sense == 'G' ? rhs : -kHighsInf);
+		vector<double> upper(numRows, sense == 'G' ? kHighsInf : rhs);
+		vector<HighsInt> starts(rowStart, rowStart + numRows);
+		vector<HighsInt> indices(columns, columns + numNonzeros);
+		check(highs.addRows(numRows, lower.data(), upper.data(), numNonzeros, starts.data(), indices.data(), values), "add the constraints");
+	}
+
+	void writeModel(const char * path) {
+		check(highs.writeModel(path), "write the ILP model");
+	}
+
+	void setStart(int count, const int * columns, const double * values) {
+		vector<HighsInt> indices(columns, columns + count);
+		check(highs.setSolution(count, indices.data(), values), "set the start solution");
+	}
+
+	void changeRhs(int row, char sense, double rhs) {
+		check(highs.changeRowBounds(row, sense == 'G' ? rhs : -kHighsInf, sense == 'G' ? kHighsInf : rhs), "change the right-hand side");
+	}
+
+	bool solve(int, int seconds, const char * solutionPath, int count, double * values) {
+		highs.setOptionValue("time_limit", double(seconds));
+		check(highs.run(), "solve the ILP model");
+		if (highs.getInfo().primal_solution_status != kSolutionStatusFeasible)
+			return false;
+		if (solutionPath)
+			check(highs.writeSolution(solutionPath, kSolutionStylePretty), "write the solution file");
+		const vector<double> & solution = highs.getSolution().col_value;
+		copy(solution.begin(), solution.begin() + count, values);
+		return true;
+	}
+
+	void relax() {
+		int count = highs.getNumCol();
+		vector<HighsVarType> continuous(count, HighsVarType::kContinuous);
+		if (count)
+			check(highs.changeColsIntegrality(0, count - 1, continuous.data()), "relax the ILP model");
+		relaxed = true;
+	}
+
+	bool solveRelaxation(int, int seconds, int numRows, double * duals, double & objective) {
+		highs.setOptionValue("time_limit", double(seconds));
+		check(highs.run(), "solve the LP relaxation");
+		if (highs.getModelStatus() != HighsModelStatus::kOptimal)
+			return false;
+		objective = highs.getInfo().objective_function_value;
+		const vector<double> & rowDuals = highs.getSolution().row_dual;
+		copy(rowDuals.begin(), rowDuals.begin() + numRows, duals);
+		return true;
+	}
+
+	void clear() {
+		check(highs.clearModel(), "clear the ILP model");
+		highs.changeObjectiveSense(ObjSense::kMaximize);
+		relaxed = false;
+	}
+};
+
+int HighsSolver::threads = 0;	// 0 lets HiGHS choose
+#endif
+
+/*
+	The MIP backends this build of mcsc was compiled with (the USE_CPLEX and USE_HIGHS flags). The first one is the default solver, or the greedy heuristic if there is none.
+*/
+const vector<string> mipSolverNames = {
+#ifdef USE_CPLEX
+	"cplex",
+#endif
+#ifdef USE_HIGHS
+	"highs",
+#endif
+};
+
+MipSolver * createMipSolver(const string & name, bool screenOutput) {
+#ifdef USE_CPLEX
+	if (name == "cplex") return new CplexSolver(screenOutput);
+#endif
+#ifdef USE_HIGHS
+	if (name == "highs") return new HighsSolver(screenOutput);
+#endif
+	return NULL;
+}
+
+/*
+	Sets the number of threads of the backends that cannot change it between solves. Has to be called before the first solver is created.
+*/
+void setMipSolverThreads(int threads) {
+#ifdef USE_HIGHS
+	HighsSolver::threads = threads;
+#else
+	(void) threads;
+#endif
+}
+
+// Number of threads that every solve of the named backend uses, whatever it is given, or 0 if it uses the given number
+int fixedMipSolverThreads(const string & name) {
+#ifdef USE_HIGHS
+	if (name == "highs") return HighsSolver::threads;
+#endif
+	(void) name;
+	return 0;
+}
+
+/*
+	A selection problem for the backends below: pick at most K of the X columns, i.e. of the proper subgraphs that remain after the presolve, so that as many seeds as possible have a picked column in the coverage list of their pair.
+*/
+struct CoverProblem {
+	NodeCoverIndex & nodeCover;
+	vector<CandidateLevel> & levels;
+	const vector<int> & columnSubgraph;	// Proper subgraph of every X column
+	int K;
+	int threads;
+	int seconds;
+
+	// Calls visit(p) for every pair p covered by the subgraph of the given column
+	template <class Visit>
+	void forEachPair(llu column, Visit visit) {
+		llu i = columnSubgraph[column];
+		int sizeIdx = 0;
+		while (i >= levels[sizeIdx].count()) i -= levels[sizeIdx++].count();
+		nodeCover.forEachPair(levels[sizeIdx].nodesOf(i), levels[sizeIdx].size, levels[sizeIdx].samplesOf(i), visit);
+	}
+
+	// Number of seeds of every pair
+	vector<int> pairWeights() {
+		vector<int> weight(nodeCover.coverStart.size() - 1, 0);
+		for (llu k = 0; k < subnetworkSeeds.size(); k++)
+			weight[ nodeCover.seedPair[k] ]++;
+		return weight;
+	}
+};
+
+/*
+	Builds the selection ILP against the given MIP backend, with a budget of problem.K columns.
+	Columns 0 .. numX - 1 are the X variables, one per column of the problem, followed by the C variables of the seeds that can be covered. The coverage rows are copied from the node cover index in batches.
+	Returns the index of the budget row, which is the last one.
+*/
+int buildMipModel(CoverProblem & problem, MipSolver & solver) {
+	NodeCoverIndex & nodeCover = problem.nodeCover;
+	llu numX = problem.columnSubgraph.size();
+	clock_t timerStart;
+	if (numX + subnetworkSeeds.size() >= llu(INT_MAX)) {
+		fprintf(stderr, "\n< Error > %llu subgraphs and %llu seeds are too many columns for the ILP model. Exiting program.\n", numX, llu(subnetworkSeeds.size()));
+		exit(0);
+	}
+	solver.addBinaryColumns(numX, NULL);
+	fprintf(stderr, "\tConstructed X variables.\n");
+
+	// Maximize the number of covered nodes
+	timerStart = clock();
+	vector<int> seedColumn(subnetworkSeeds.size(), -1);
+	int numColumns = numX;
+	for (llu k = 0; k < subnetworkSeeds.size(); k++) {
+		if (nodeCover.coverSize(nodeCover.seedPair[k]))
+			seedColumn[k] = numColumns++;
+	}
+	{
+		vector<double> ones(numColumns - numX, 1);
+		solver.addBinaryColumns(numColumns - numX, ones.data());
+	}
+	fprintf(stderr, "\tConstructed C variables.\n");
+	fprintf(stderr, "\tConstructed the objective function. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+
+	// No element can be covered without a set that contains it being picked
+	timerStart = clock();
+	const llu rowBatchNonzeros = 1 << 24;
+	vector<int> rowStart;
+	vector<int> rowColumns;
+	vector<double> rowValues;
+	int numRows = 0;
+	auto addRows = [&](char sense, double rhs) {
+		solver.addRows(rowStart.size(), rowStart.data(), rowColumns.size(), rowColumns.data(), rowValues.data(), sense, rhs);
+		numRows += rowStart.size();
+		rowStart.clear();
+		rowColumns.clear();
+		rowValues.clear();
+	};
+	fprintf(stderr, "\tAdding constraints: \n");
+	for (llu k = 0, lastProg = 0; k < subnetworkSeeds.size(); k++) {
+		llu progress = 1000 * double(k + 1) / double(subnetworkSeeds.size());
+		if (progress > lastProg) {
+			fprintf(stderr, "\r\t%.1lf%%", double(progress)/10.0);
+			lastProg = progress;
+		}
+		llu pairIdx		= nodeCover.seedPair[k];
+		llu numCovering	= nodeCover.coverSize(pairIdx);
+		if (numCovering == 0)
+			continue;
+		if (rowColumns.size() + numCovering + 1 > rowBatchNonzeros && !rowStart.empty())
+			addRows('G', 0);
+		// sum of X over the covering subgraphs - C[k] >= 0
+		rowStart.push_back(rowColumns.size());
+		const int * covering = nodeCover.coverOf(pairIdx);
+		rowColumns.insert(rowColumns.end(), covering, covering + numCovering);
+		rowValues.resize(rowColumns.size(), 1);
+		rowColumns.push_back(seedColumn[k]);
+		rowValues.push_back(-1);
+	}
+	if (!rowStart.empty())
+		addRows('G', 0);
+	fprintf(stderr, "\r\tAdded coverage constraints. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+
+	// Number of sets that we can pick is at most K
+	timerStart = clock();
+	rowStart.push_back(0);
+	for (llu i = 0; i < numX; i++)
+		rowColumns.push_back(i);
+	rowValues.resize(numX, 1);
+	addRows('L', problem.K);
+	fprintf(stderr, "\r\tAdded set number constraint. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC); 
+	return numRows - 1;
+}
+
+/*
+	Selection with the ILP built by buildMipModel, which is re-solved with the budget row set to problem.K. Every selection in starts is passed as a MIP start.
+	Returns false if no solution was found.
+*/
+bool selectWithMip(CoverProblem & problem, MipSolver & solver, int budgetRow, const char * solutionPath, const vector< vector<char> > & starts, vector<char> & selected) {
+	llu numX = problem.columnSubgraph.size();
+	solver.changeRhs(budgetRow, 'L', problem.K);
+	for (const vector<char> & start : starts) {
+		vector<int> startColumns(numX);
+		vector<double> startValues(numX);
+		for (llu i = 0; i < numX; i++) {
+			startColumns[i] = i;
+			startValues[i] = start[i];
+		}
+		solver.setStart(numX, startColumns.data(), startValues.data());
+	}
+	vector<double> X(numX);
+	bool solved = solver.solve(problem.threads, problem.seconds, solutionPath, numX, X.data());
+	for (llu i = 0; solved && i < numX; i++)
+		selected[i] = X[i] > 0.5;
+	return solved;
+}
+
+/*
+	Selection with the lazy greedy (CELF) heuristic for maximum coverage, which covers at least a (1 - 1/e) fraction of the optimum.
+	The column covering most uncovered seeds is picked K times. Gains only drop as columns are picked, so the column on top of the heap is picked if its gain was computed in the current round, and is otherwise re-evaluated and pushed back.
+	Returns the number of covered seeds.
+*/
+llu selectGreedy(CoverProblem & problem, vector<char> & selected) {
+	clock_t timerStart = clock();
+	llu numX = problem.columnSubgraph.size();
+	vector<int> weight = problem.pairWeights();
+	vector<char> covered(weight.size(), 0);
+	auto gainOf = [&](llu column) {
+		llu gain = 0;
+		problem.forEachPair(column, [&](llu p) { if (!covered[p]) gain += weight[p]; });
+		return gain;
+	};
+
+	vector< pair<llu, int> > heap(numX);	// (gain, -column), so that ties go to the first column
+	runInParallel(problem.threads, [&](int threadIdx) {
+		for (llu column = numX * threadIdx / problem.threads; column < numX * (threadIdx + 1) / problem.threads; column++)
+			heap[column] = make_pair(gainOf(column), -int(column));
+	});
+	make_heap(heap.begin(), heap.end());
+	vector<int> gainRound(numX, 0);
+	int numPicked = 0;
+	llu numCovered = 0;
+	while (numPicked < problem.K && !heap.empty()) {
+		pair<llu, int> top = heap.front();
+		pop_heap(heap.begin(), heap.end());
+		heap.pop_back();
+		int column = -top.second;
+		if (gainRound[column] == numPicked) {
+			if (top.first == 0)
+				break;
+			selected[column] = 1;
+			numPicked++;
+			numCovered += top.first;
+			problem.forEachPair(column, [&](llu p) { covered[p] = 1; });
+		}
+		else {
+			gainRound[column] = numPicked;
+			heap.push_back(make_pair(gainOf(column), -column));
+			push_heap(heap.begin(), heap.end());
+		}
+	}
+	fprintf(stderr, "\tGreedy selection picked %d subnetworks, covering %llu nodes. (%.2lf seconds)\n", numPicked, numCovered, double(clock() - timerStart) / CLOCKS_PER_SEC);
+	return numCovered;
+}
+
+/*
+	An independent block of the selection problem. The blocks are the connected components of the graph in which two columns are joined when they cover the pair of a common seed, so only the budget of K columns couples them.
+*/
+struct CoverBlock {
+	vector<int> columns;			// X columns of the block, in increasing order
+	vector<llu> pairs;				// Seed pairs covered by its columns
+	llu numSeeds;					// Seeds of these pairs
+	vector<llu> coverage;			// coverage[k] = most seeds covered by k of its columns that were found
+	vector< vector<int> > picks;	// picks[k] = the columns that cover coverage[k] seeds
+};
+
+// Blocks with at most this many columns are solved by trying every subset of their columns instead of a MIP
+const int maxEnumeratedBlockColumns = 4;
+
+/*
+	Splits the columns into blocks with a union-find over the coverage lists of the seed pairs. Columns that cover no seed are left out.
+*/
+vector<CoverBlock> findCoverBlocks(CoverProblem & problem, const vector<int> & weight) {
+	NodeCoverIndex & nodeCover = problem.nodeCover;
+	llu numX = problem.columnSubgraph.size();
+	vector<int> parent(numX);
+	for (llu i = 0; i < numX; i++)
+		parent[i] = i;
+	auto root = [&](int i) {
+		while (parent[i] != i)
+			i = parent[i] = parent[ parent[i] ];
+		return i;
+	};
+	for (llu p = 0; p < weight.size(); p++) {
+		if (!weight[p] || !nodeCover.coverSize(p))
+			continue;
+		const int * covering = nodeCover.coverOf(p);
+		int first = root(covering[0]);
+		for (llu e = 1; e < nodeCover.coverSize(p); e++) {
+			int other = root(covering[e]);
+			if (other != first)
+				parent[other] = first;
+		}
+	}
+	vector<int> blockOf(numX, -1);	// blockOf[r] = block of the columns with root r
+	vector<CoverBlock> blocks;
+	for (llu p = 0; p < weight.size(); p++) {
+		if (!weight[p] || !nodeCover.coverSize(p))
+			continue;
+		int r = root(nodeCover.coverOf(p)[0]);
+		if (blockOf[r] == -1) {
+			blockOf[r] = blocks.size();
+			blocks.push_back(CoverBlock());
+			blocks.back().numSeeds = 0;
+		}
+		blocks[ blockOf[r] ].pairs.push_back(p);
+		blocks[ blockOf[r] ].numSeeds += weight[p];
+	}
+	for (llu i = 0; i < numX; i++) {
+		int r = root(i);
+		if (blockOf[r] != -1)
+			blocks[ blockOf[r] ].columns.push_back(i);
+	}
+	return blocks;
+}
+
+/*
+	Builds the model of a block in an empty solver, without its budget row: its X columns 0 .. numColumns - 1, then a C column per pair weighted by the seeds of the pair, and the coverage rows of the pairs.
+*/
+void buildBlockModel(CoverProblem & problem, const vector<int> & weight, const vector<int> & localColumn, CoverBlock & block, MipSolver * solver) {
+	NodeCoverIndex & nodeCover = problem.nodeCover;
+	int numColumns = block.columns.size();
+	int numPairs = block.pairs.size();
+	solver->addBinaryColumns(numColumns, NULL);
+	vector<double> objective(numPairs);
+	for (int j = 0; j < numPairs; j++)
+		objective[j] = weight[ block.pairs[j] ];
+	solver->addBinaryColumns(numPairs, objective.data());
+	vector<int> rowStart, rowColumns;
+	vector<double> rowValues;
+	for (int j = 0; j < numPairs; j++) {
+		// sum of X over the covering subgraphs - C[j] >= 0
+		rowStart.push_back(rowColumns.size());
+		const int * covering = nodeCover.coverOf(block.pairs[j]);
+		for (llu e = 0; e < nodeCover.coverSize(block.pairs[j]); e++)
+			rowColumns.push_back(localColumn[ covering[e] ]);
+		rowValues.resize(rowColumns.size(), 1);
+		rowColumns.push_back(numColumns + j);
+		rowValues.push_back(-1);
+	}
+	solver->addRows(numPairs, rowStart.data(), rowColumns.size(), rowColumns.data(), rowValues.data(), 'G', 0);
+}
+
+/*
+	Number of seeds of a block that the picked columns cover, picked being indexed by the position of the column in the block.
+*/
+llu blockCoverage(CoverProblem & problem, const vector<int> & weight, const vector<int> & localColumn, CoverBlock & block, const vector<char> & picked) {
+	NodeCoverIndex & nodeCover = problem.nodeCover;
+	llu covered = 0;
+	for (llu p : block.pairs) {
+		const int * covering = nodeCover.coverOf(p);
+		for (llu e = 0; e < nodeCover.coverSize(p); e++) {
+			if (picked[ localColumn[ covering[e] ] ]) {
+				covered += weight[p];
+				break;
+			}
 		}
-		totalNumSubgraphs += candidateSubnetworks[cycle].size();
 	}
-	delete [] nodesHash_buckets;
-	delete nodesHash;
-	delete visitedNode;
-	fprintf(stderr, "\nConstructed all candidate subnetworks. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
-	fprintf(stderr, "Total amount of subgraphs of all sizes up to %d which are recurrent in at least %d patients is %llu.\n", S, t, totalNumSubgraphs);
-	fprintf(stderr, "%llu subgraphs are contained in a subgraph of larger size with the same patients, and are discarded.\n", numContained);
+	return covered;
+}
 
-	//
-	//	STAGE 4: Filtering out candidate subnetworks based on their colour properties.
-	//
-	fprintf(stderr, "Filtering out homogenous (colour-wise) subnetworks.\n"); timerStart = clock();
-	llu numImproperlyColoured = 0;
-	llu numConsidered = 0;
-	llu * colourCount = new llu [alterations.indices.size() + 1];
-	memset(colourCount, 0, sizeof(colourCount[0]) * (1 + alterations.indices.size()));
-	for (llu sizeIdx = 0, currentSubgraphCounter = 0; sizeIdx < S; sizeIdx++) {
-		for (int i = 0, lastProg = 0; i < candidateSubnetworks[sizeIdx].size(); i++) {
-			currentSubgraphCounter++;
-			int progress = 1000 * double(currentSubgraphCounter) / double(totalNumSubgraphs);
-			if (progress > lastProg) {
-				fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
-				lastProg = progress;
+/*
+	Fills in the coverage curve of a block, for 0 .. K columns or until all of its seeds are covered.
+	Blocks of up to maxEnumeratedBlockColumns columns try every subset of their columns. Larger ones build their model in the given solver, which is cleared first, and raise its budget row one column at a time. Every solve starts from the columns of the previous one, which stay feasible, and the curve stops early if a solve finds nothing before the deadline.
+*/
+void solveCoverBlock(CoverProblem & problem, const vector<int> & weight, const vector<int> & localColumn, CoverBlock & block, MipSolver * solver, int threads, time_t deadline) {
+	int numColumns = block.columns.size();
+	block.coverage.assign(1, 0);
+	block.picks.assign(1, vector<int>());
+	if (numColumns <= maxEnumeratedBlockColumns) {
+		vector<llu> subsetCoverage(numColumns + 1, 0);	// Most seeds covered by a subset of k columns, and that subset
+		vector<int> subsetMask(numColumns + 1, 0);
+		vector<char> picked(numColumns);
+		for (int mask = 1; mask < (1 << numColumns); mask++) {
+			for (int i = 0; i < numColumns; i++)
+				picked[i] = (mask >> i) & 1;
+			int k = __builtin_popcount(mask);
+			llu covered = blockCoverage(problem, weight, localColumn, block, picked);
+			if (covered > subsetCoverage[k]) {
+				subsetCoverage[k] = covered;
+				subsetMask[k] = mask;
 			}
-			SubnetworkEntry & subnetInfo = candidateSubnetworks[sizeIdx][i];
-			if (subnetInfo.isValid) {
-				numConsidered++;
-				// vector<llu> nodeColourMasks = subnetInfo.getNodeColourBitmaskVector(geneAlterations);
-				llu expressionOutlierBitmask = llu(1) << alterations.indices["EXPROUT"];
-				// int numNonOutlier = 0;
-				llu subnetColourBitmask = 0;
-				for (llu colourIdx : subnetInfo.nodeColourIdx) {
-					// if ((expressionOutlierBitmask & nodeColourBitmask) == 0)
-						// numNonOutlier++;
-					subnetColourBitmask |= llu(1) << colourIdx;
-				}
-				int numColours = __builtin_popcountll(subnetColourBitmask);
-				colourCount[numColours]++;
-				// if (numNonOutlier < 2) {
-				if (numColours < minColours) {
-					subnetInfo.isValid = false;
-					numImproperlyColoured++;
+		}
+		for (int k = 1; k <= min(problem.K, numColumns) && block.coverage.back() < block.numSeeds; k++) {
+			if (subsetCoverage[k] > block.coverage.back()) {
+				block.picks.push_back(vector<int>());
+				for (int i = 0; i < numColumns; i++) {
+					if ((subsetMask[k] >> i) & 1) block.picks.back().push_back(block.columns[i]);
 				}
+				block.coverage.push_back(subsetCoverage[k]);
+			}
+			else {
+				block.picks.push_back(block.picks.back());
+				block.coverage.push_back(block.coverage.back());
 			}
 		}
+		return;
 	}
-	fprintf(stderr, " (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
-	fprintf(stderr, "%llu subgraphs were considered.\n", numConsidered);
-	for (int i = 1; i <= alterations.indices.size(); i++) {
-		fprintf(stderr, "\t%llu subnetworks have %d colour%s among their nodes.\n", colourCount[i], i, i > 1 ? "s" : "");
-	}
-	if (minColours > 1) {
-		fprintf(stderr, "%llu subgraphs do not have at least %d differently-coloured nodes, and are discarded.\n", minColours, numImproperlyColoured);
-	}
-	delete colourCount;
-
-	//
-	//	STAGE 4.5: constructing array of all valid subnetworks.
-	//
-
-	llu numProperSubgraphs = totalNumSubgraphs - numContained - numImproperlyColoured;
-	SubnetworkEntry ** properSubgraphs = new SubnetworkEntry * [numProperSubgraphs];
-	numProperSubgraphs = 0;
-	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++) {
-		for (int i = 0; i < candidateSubnetworks[sizeIdx].size(); i++) {
-			if (candidateSubnetworks[sizeIdx][i].isValid) {
-				properSubgraphs[numProperSubgraphs] = & candidateSubnetworks[sizeIdx][i];
-				numProperSubgraphs++;
+	solver->clear();
+	buildBlockModel(problem, weight, localColumn, block, solver);
+	int budgetStart = 0;
+	vector<int> budgetColumns(numColumns);
+	for (int i = 0; i < numColumns; i++)
+		budgetColumns[i] = i;
+	vector<double> ones(numColumns, 1);
+	solver->addRows(1, &budgetStart, numColumns, budgetColumns.data(), ones.data(), 'L', 1);
+
+	vector<double> X(numColumns, 0);
+	vector<char> picked(numColumns);
+	for (int k = 1; k <= min(problem.K, numColumns) && block.coverage.back() < block.numSeeds; k++) {
+		int remaining = deadline - time(NULL);
+		if (remaining <= 0)
+			break;
+		if (k > 1) {
+			solver->changeRhs(block.pairs.size(), 'L', k);
+			solver->setStart(numColumns, budgetColumns.data(), X.data());
+		}
+		if (!solver->solve(threads, remaining, NULL, numColumns, X.data()))
+			break;
+		for (int i = 0; i < numColumns; i++)
+			picked[i] = X[i] > 0.5;
+		// The seeds are counted from the picked columns rather than taken from the objective, which may be off by the solver tolerances
+		llu covered = blockCoverage(problem, weight, localColumn, block, picked);
+		if (covered > block.coverage.back()) {
+			block.picks.push_back(vector<int>());
+			for (int i = 0; i < numColumns; i++) {
+				if (picked[i]) block.picks.back().push_back(block.columns[i]);
 			}
+			block.coverage.push_back(covered);
+		}
+		else {	// A solve cut short by the deadline did not improve on k - 1 columns
+			block.picks.push_back(block.picks.back());
+			block.coverage.push_back(block.coverage.back());
+			fill(X.begin(), X.end(), 0);
+			for (int column : block.picks.back())
+				X[ localColumn[column] ] = 1;
 		}
 	}
-	fprintf(stderr, "%llu proper subgraphs are considered.\n", numProperSubgraphs);
+}
 
-	//
-	//	STAGE 5: Extending candidate subnetworks to include samples in which there aren't all exact matches, but there aren't colour conflicts either. 
-	//
+/*
+	Selection with the ILP, decomposed into independent blocks.
+	The coverage curves of all blocks but the largest are solved in parallel, largest first, and merged by a knapsack over up to maxK columns: best[j] is the most seeds that at most j columns cover in the blocks merged so far.
+	The largest block, which usually holds most of the columns, would need a solve per point of its curve, so it is solved once per K instead, together with the merged curve: a Y column per j, with objective best[j] and j units of the budget, of which at most one is picked.
+	The curves and the model are built once, for the largest K, and select() re-solves the model with the budget of the current K. The curves are solved by one MIP solver per thread, which is reused for all of its blocks, and they share the time limit of the first selection.
+*/
+struct BlockSelection {
+	vector<CoverBlock> & blocks;
+	const vector<int> & weight;
+	vector<int> localColumn;
+	vector<int> order;				// The blocks but the largest, by decreasing size
+	int largest;
+	vector<llu> best;
+	vector< vector<int> > take;		// take[b][j] = columns of block order[b] in best[j] after merging it
+	MipSolver * solver;
+	int numColumns, numPairs, maxK;	// Of the model of the largest block, with Y[j] = numColumns + numPairs + j - 1
+	vector<double> values;			// The last solution, empty if there is none
+	time_t deadline;				// End of the time limit of the first selection, 0 once it is made
 
-	if (errorRate >= 1.0/S) {
-		timerStart = clock();
-		llu numSubnetworksExtended = 0;
-		llu numSamplesAdded = 0;
-		fprintf(stderr, "Extending subnetworks to include %d%% errors...\n", int(errorRate * 100));
-		for (int i = 0, lastProg = 0; i < numProperSubgraphs; i++) {
-			int progress = 1000 * double(i + 1) / double(numProperSubgraphs);
-			if (progress > lastProg) {
-				fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
-				lastProg = progress;
-			}
-			SubnetworkEntry * subnetInfo = properSubgraphs[i];
-			if (subnetInfo->isValid) {
-				int numSamplesBefore = subnetInfo->numSamples();
-				subnetInfo->extendSubnetworkWithError(geneAlterations, samples, errorRate);
-				int numSamplesAfter = subnetInfo->numSamples();
-				if (numSamplesAfter > numSamplesBefore) {
-					numSubnetworksExtended++;
-					numSamplesAdded += numSamplesAfter - numSamplesBefore;
+	/*
+		The model of the largest block is written to modelPath unless it is NULL.
+	*/
+	BlockSelection(CoverProblem & problem, vector<CoverBlock> & blocks, const vector<int> & weight, const char * solverName, int maxK, const char * modelPath) : blocks(blocks), weight(weight), maxK(maxK) {
+		clock_t timerStart = clock();
+		deadline = time(NULL) + problem.seconds;
+		CoverProblem curveProblem = problem;
+		curveProblem.K = maxK;
+		localColumn.assign(problem.columnSubgraph.size(), -1);
+		largest = 0;
+		for (llu b = 0; b < blocks.size(); b++) {
+			for (llu i = 0; i < blocks[b].columns.size(); i++)
+				localColumn[ blocks[b].columns[i] ] = i;
+			if (blocks[b].columns.size() > blocks[largest].columns.size())
+				largest = b;
+		}
+		for (llu b = 0; b < blocks.size(); b++) {
+			if (b != llu(largest)) order.push_back(b);
+		}
+		sort(order.begin(), order.end(), [&](int a, int b) { return blocks[a].columns.size() > blocks[b].columns.size(); });
+		vector<int> mipBlocks;		// The blocks that are too large to try every subset of their columns
+		for (int b : order) {
+			if (int(blocks[b].columns.size()) > maxEnumeratedBlockColumns)
+				mipBlocks.push_back(b);
+			else
+				solveCoverBlock(curveProblem, weight, localColumn, blocks[b], NULL, 1, deadline);
+		}
+		if (!mipBlocks.empty()) {
+			// A backend with a fixed number of threads runs as many solves at once as fit in the threads
+			int fixedThreads = fixedMipSolverThreads(solverName);
+			int numWorkers = min(fixedThreads ? max(1, problem.threads / fixedThreads) : problem.threads, int(mipBlocks.size()));
+			int solveThreads = fixedThreads ? fixedThreads : max(1, problem.threads / numWorkers);
+			vector<MipSolver *> workerSolvers(numWorkers);
+			for (int threadIdx = 0; threadIdx < numWorkers; threadIdx++)
+				workerSolvers[threadIdx] = createMipSolver(solverName, false);
+			atomic<llu> nextBlock(0);
+			runInParallel(numWorkers, [&](int threadIdx) {
+				for (llu b = nextBlock++; b < mipBlocks.size(); b = nextBlock++)
+					solveCoverBlock(curveProblem, weight, localColumn, blocks[ mipBlocks[b] ], workerSolvers[threadIdx], solveThreads, deadline);
+			});
+			for (MipSolver * workerSolver : workerSolvers)
+				delete workerSolver;
+		}
+
+		best.assign(maxK + 1, 0);
+		take.resize(order.size());
+		for (llu b = 0; b < order.size(); b++) {
+			const vector<llu> & coverage = blocks[ order[b] ].coverage;
+			vector<llu> merged(best);
+			take[b].assign(maxK + 1, 0);
+			for (int j = 1; j <= maxK; j++) {
+				for (int k = 1; k <= j && k < int(coverage.size()); k++) {
+					if (best[j - k] + coverage[k] > merged[j]) {
+						merged[j] = best[j - k] + coverage[k];
+						take[b][j] = k;
+					}
 				}
 			}
+			best.swap(merged);
 		}
-		fprintf(stderr, "\rDone. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
-		fprintf(stderr, "%llu subnetworks have been extended.\n", numSubnetworksExtended);
-		fprintf(stderr, "Average number of samples added is %.1lf\n", double(numSamplesAdded) / numSubnetworksExtended);
-	}
-	
-	vector<int> * nodeCover = new vector<int> [G.V * samples.indices.size()];
-	timerStart = clock();
-	for (llu i = 0; i < numProperSubgraphs; i++) {
-		SubnetworkEntry * subnetInfo = properSubgraphs[i];
-		Bitmask tempmask(subnetInfo->samples);
-		while (tempmask.getSize()) {
-			int sampleIdx = tempmask.extractLowestOrderSetBitIndex();
-			for (int nodeIdx : subnetInfo->nodes) {
-				llu commonIdx = sampleIdx * G.V + nodeIdx;
-				nodeCover[commonIdx].push_back(i);
-			}
+		fprintf(stderr, "\tSolved and merged the coverage curves of the other %llu blocks, whose best %d subnetworks cover %llu nodes. (%.2lf seconds)\n", llu(order.size()), maxK, best[maxK], double(clock() - timerStart) / CLOCKS_PER_SEC);
+
+		CoverBlock & block = blocks[largest];
+		numColumns = block.columns.size();
+		numPairs = block.pairs.size();
+		solver = createMipSolver(solverName, true);
+		buildBlockModel(problem, weight, localColumn, block, solver);
+		vector<double> curve(best.begin() + 1, best.end());
+		solver->addBinaryColumns(maxK, curve.data());
+		vector<int> rowStart(1, 0), rowColumns;
+		vector<double> rowValues;
+		for (int j = 1; j <= maxK; j++) {
+			rowColumns.push_back(numColumns + numPairs + j - 1);
+			rowValues.push_back(1);
+		}
+		solver->addRows(1, rowStart.data(), maxK, rowColumns.data(), rowValues.data(), 'L', 1);
+		for (int i = 0; i < numColumns; i++) {
+			rowColumns.push_back(i);
+			rowValues.push_back(1);
+		}
+		for (int j = 1; j <= maxK; j++)
+			rowValues[j - 1] = j;
+		solver->addRows(1, rowStart.data(), rowColumns.size(), rowColumns.data(), rowValues.data(), 'L', problem.K);
+		if (modelPath) {
+			solver->writeModel(modelPath);
+			fprintf(stderr, "ILP model file of the largest block written to '%s'.\n", modelPath);
 		}
 	}
-	fprintf(stderr, "\tCalculated node covers. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
 
-	IloEnv env;
-	IloModel model(env);
-	IloExpr objective(env);
-	IloBoolVarArray X(env, numProperSubgraphs);
-	fprintf(stderr, "\tConstructed X variables.\n");
-	IloBoolVarArray C(env, subnetworkSeeds.size());
-	fprintf(stderr, "\tConstructed C variables.\n");
+	~BlockSelection() {
+		delete solver;
+	}
 
-	// Maximize the number of covered nodes
+	/*
+		Selection for a budget of problem.K columns. It starts from the merged curve alone, so that a solution is known from the start, and from the previous solution, which had a smaller budget.
+		The first selection has what the curves left of its time limit, and every later one has a full time limit.
+		Returns false if no solution was found, and otherwise the number of covered seeds in numCovered.
+	*/
+	bool select(CoverProblem & problem, vector<char> & selected, llu & numCovered) {
+		int numAll = numColumns + numPairs + maxK;
+		solver->changeRhs(numPairs + 1, 'L', problem.K);
+		int startColumn = numColumns + numPairs + problem.K - 1;
+		double startValue = 1;
+		solver->setStart(1, &startColumn, &startValue);
+		if (!values.empty()) {
+			vector<int> allColumns(numAll);
+			for (int i = 0; i < numAll; i++)
+				allColumns[i] = i;
+			solver->setStart(numAll, allColumns.data(), values.data());
+		}
+		values.resize(numAll);
+		int seconds = deadline ? max(1, int(deadline - time(NULL))) : problem.seconds;
+		deadline = 0;
+		if (!solver->solve(problem.threads, seconds, NULL, numAll, values.data())) {
+			values.clear();
+			return false;
+		}
+
+		CoverBlock & block = blocks[largest];
+		vector<char> picked(numColumns);
+		for (int i = 0; i < numColumns; i++) {
+			picked[i] = values[i] > 0.5;
+			if (picked[i]) selected[ block.columns[i] ] = 1;
+		}
+		llu j = 0;
+		for (int k = 1; k <= maxK; k++) {
+			if (values[numColumns + numPairs + k - 1] > 0.5) j = k;
+		}
+		numCovered = blockCoverage(problem, weight, localColumn, block, picked) + best[j];
+		for (llu b = order.size(); b-- > 0; ) {
+			int k = take[b][j];
+			for (int column : blocks[ order[b] ].picks[k])
+				selected[column] = 1;
+			j -= k;
+		}
+		return true;
+	}
+};
+
+/*
+	Selection of the subnetworks among the proper subgraphs for every K, and output to folderName. The proper subgraphs are recurrent in at least 't' patients.
+	Every K has a time limit of 'seconds', except that the first one ends at the deadline instead if it is not 0.
+*/
+void selectSubnetworks(vector<CandidateLevel> & candidateSubnetworks, int t, const vector<int> & Ks, const char * folderName, int workerThreads, int seconds, time_t deadline, const char * modelFormat, int presolveLevel, const char * solverName, bool greedyStart, bool decompose) {
+	const int numPatients = samples.indices.size();
+	const int S = candidateSubnetworks.size();
+	vector<llu> properLevelStart(S + 1, 0);
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+		properLevelStart[sizeIdx + 1] = properLevelStart[sizeIdx] + candidateSubnetworks[sizeIdx].count();
+	llu numProperSubgraphs = properLevelStart[S];
+	// Returns the view of the i-th proper subgraph
+	auto properSubgraph = [&](llu i) {
+		int sizeIdx = upper_bound(properLevelStart.begin(), properLevelStart.end(), i) - properLevelStart.begin() - 1;
+		return candidateSubnetworks[sizeIdx].view(i - properLevelStart[sizeIdx]);
+	};
+	clock_t timerStart;
+
+	NodeCoverIndex nodeCover;
 	timerStart = clock();
-	for (llu i = 0; i < subnetworkSeeds.size(); i++) {
-		int sampleIdx		= subnetworkSeeds[i].first;
-		int nodeIdx			= subnetworkSeeds[i].second;
-		llu commonIdx		= sampleIdx * G.V + nodeIdx;
-		if (!nodeCover[commonIdx].empty())
-			objective += C[i];
+	nodeCover.build(candidateSubnetworks, workerThreads);
+	fprintf(stderr, "\tCalculated node covers. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	vector<int> columnSubgraph;	// Proper subgraph of every X column
+	if (presolveLevel > 0)
+		columnSubgraph = presolveCandidates(nodeCover, candidateSubnetworks, presolveLevel, workerThreads);
+	else {
+		for (llu i = 0; i < numProperSubgraphs; i++)
+			columnSubgraph.push_back(i);
 	}
-	model.add( IloMaximize(env, objective) );
-	fprintf(stderr, "\tConstructed the objective function. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	llu numX = columnSubgraph.size();
 
-	// No element can be covered without a set that contains it being picked
+	// Nodes that no subgraph covers are left out of the selection
 	llu uncoveredNodeCnt = 0;
-	timerStart = clock();
 	llu averageCoverage = 0;
 	unordered_set<int> samplesWithNodesThatCanBeCovered;
-	fprintf(stderr, "\tAdding constraints: \n");
-	for (int k = 0, lastProg = 0; k < subnetworkSeeds.size(); k++) {
-		int progress = 1000 * double(k + 1) / double(subnetworkSeeds.size());
-		if (progress > lastProg) {
-			fprintf(stderr, "\r\t%.1lf%%", double(progress)/10.0);
-			lastProg = progress;
-		}
-		int node_sampleIdx		= subnetworkSeeds[k].first;
-		int node_nodeIdx		= subnetworkSeeds[k].second;
-		int node_commonIdx		= node_sampleIdx * G.V + node_nodeIdx;
-		// llu subnetworkCnt = 0;
-		if (nodeCover[node_commonIdx].size()) {
-			samplesWithNodesThatCanBeCovered.insert(node_sampleIdx);
-			IloExpr e(env);
-			for (int subgraphIdx : nodeCover[node_commonIdx]) {
-				e += X[subgraphIdx];
-			}
-			model.add(e >= C[k]);
-			averageCoverage += nodeCover[node_commonIdx].size();
+	for (llu k = 0; k < subnetworkSeeds.size(); k++) {
+		llu numCovering = nodeCover.coverSize(nodeCover.seedPair[k]);
+		if (numCovering) {
+			samplesWithNodesThatCanBeCovered.insert(subnetworkSeeds[k].first);
+			averageCoverage += numCovering;
 		}
 		else
 			uncoveredNodeCnt++;
 	}
-	fprintf(stderr, "\r\tAdded coverage constraints. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
-
-	// Number of sets that we can pick is at most K
-	{
-		timerStart = clock();
-		IloExpr e(env);
-		for (llu i = 0; i < numProperSubgraphs; i++) {
-			e += X[i];
-		}
-		model.add(e <= K);
-		fprintf(stderr, "\r\tAdded set number constraint. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC); 
-	}
 
 	fprintf(stderr, "\t%llu node%s cannot be covered by even a single subnetwork that is recurrent in at least %d patients, and are removed from the model.\n", uncoveredNodeCnt, uncoveredNodeCnt != 1 ? "s" : "", t);
 	fprintf(stderr, "\tThe remaining %llu nodes have on average %.1lf subgraphs that can cover them.\n", subnetworkSeeds.size() - uncoveredNodeCnt, averageCoverage / double(subnetworkSeeds.size() - uncoveredNodeCnt));
 	fprintf(stderr, "\tThose nodes belong to a total of %d samples, out of %d.\n", samplesWithNodesThatCanBeCovered.size(), samples.indices.size());
-	fprintf(stderr, "\tRunning ILP to find %d subnetworks that cover as many of the remaining nodes as possible.\n", K);
 	
-	try {
+	{
 		char command[1000];
 		// char fullFolder[1000];
 		// sprintf(fullFolder, "./%s_s%d_t%d_k%d", folderName, S, t, K);
@@ -997,155 +2944,819 @@ void runSolver(int S, int t, int K, double errorRate, const char * folderName, i
 		// system(command);
 		// sprintf(command, "mkdir -p %s", outFolder.c_str());
 		// system(command);
-		string outModel						= outFolder + "/ilp_model.lp";
-		string outSol						= outFolder + "/ilp_solution.txt";
-		string outSubnetworks				= outFolder + "/subnetworksOverview.txt";
-		string outDistributionSize			= outFolder + "/subnetwork_sizes.txt";
-		string outDistributionRecurrence	= outFolder + "/subnetwork_recurrence.txt";
-		string outSubnFolder				= outFolder + "/subnetworks";
+		string outModel						= outFolder + (strcmp(modelFormat, "sav") ? "/ilp_model.lp" : "/ilp_model.sav.gz");
+		string outBlockModel				= outFolder + (strcmp(modelFormat, "sav") ? "/ilp_model_largest_block.lp" : "/ilp_model_largest_block.sav.gz");
 		string outCandidateSamples			= outFolder + "/candidateSamples.txt";
-		string outCoveredSamples			= outFolder + "/coveredSamples.txt";
 		FILE * foutSamples = fopen(outCandidateSamples.c_str(), "w");
 		for (int sampleIdx : samplesWithNodesThatCanBeCovered) {
 			fprintf(foutSamples, "%s\n", samples.names[sampleIdx].c_str());
 		}
 		fclose(foutSamples);
 		// exit(0);	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE	// STOPS HERE
-		sprintf(command, "mkdir -p %s", outSubnFolder.c_str());
-		system(command);
-		IloCplex cplex(model);
-		cplex.exportModel(outModel.c_str());
-		fprintf(stderr, "ILP model file written to '%s'.\n", outModel.c_str());
-		cplex.setParam(IloCplex::IntParam::Threads, threads);
-		// cplex.setParam(IloCplex::NumParam::TiLim, 172800);	// 2 days
-		cplex.setParam(IloCplex::NumParam::TiLim, seconds);	// 10 hours
-		cplex.solve();
-		cplex.writeSolution(outSol.c_str());
-		fprintf(stderr, "ILP solution file written to '%s'.\n", outSol.c_str());
-		vector<int> subnetworksizes;
-		vector<int> subnetworkrecurrence;
-		FILE * fout = fopen(outSubnetworks.c_str(), "w");
-		unordered_set<int> subnetworkNodes;
-		vector<int> visited(G.V, 0);
-		llu visitedIdx = 0;
-		unordered_set<int> samplesWithCoveredNodes;
-		for (llu i = 0, subnIdx = 0; i < numProperSubgraphs; i++) {
-			if (cplex.getValue(X[i]) != 0) {
-				SubnetworkEntry * subnetInfo = properSubgraphs[i];
-				subnIdx++;
-				fprintf(fout, "Subnetwork\t%llu\n", subnIdx);
-				subnetInfo->print(geneAlterations, samples, alterations, G.chrArm, G.nodeNames, fout);
-				fprintf(fout, "\n");
-				char filename[1000];
-				sprintf(filename, "%s/%llu.edges", outSubnFolder.c_str(), subnIdx);
-				FILE * foutEdges = fopen(filename, "w");
-				sprintf(filename, "%s/%llu.adj", outSubnFolder.c_str(), subnIdx);
-				FILE * foutAdj = fopen(filename, "w");
-				sprintf(filename, "%s/%llu.nodes", outSubnFolder.c_str(), subnIdx);
-				FILE * foutNodes = fopen(filename, "w");
-				sprintf(filename, "%s/%llu.samples", outSubnFolder.c_str(), subnIdx);
-				FILE * foutSamples = fopen(filename, "w");
-				subnetworkNodes.clear();
-				for (int nodeIdx : subnetInfo -> nodes) {
-					subnetworkNodes.insert(nodeIdx);
+		CoverProblem problem = { nodeCover, candidateSubnetworks, columnSubgraph, Ks[0], workerThreads, seconds };
+		vector<CoverBlock> blocks;
+		vector<int> weight;
+		if (strcmp(solverName, "greedy") && decompose) {
+			weight = problem.pairWeights();
+			blocks = findCoverBlocks(problem, weight);
+		}
+		MipSolver * solver = NULL;					// The ILP, built for the first K and re-solved for the others
+		int budgetRow = 0;
+		BlockSelection * blockSelection = NULL;		// The same for the ILP of the blocks
+		vector<char> selected(numX, 0);
+		vector<char> previous;						// Selection of the previous K, empty if it was not solved
+		// The values of K are selected in increasing order, each in its own subfolder if there are several
+		for (int K : Ks) {
+			problem.K = K;
+			problem.seconds = deadline ? max(1, int(deadline - time(NULL))) : seconds;
+			deadline = 0;
+			string outKFolder					= Ks.size() > 1 ? outFolder + "/k" + to_string(K) : outFolder;
+			string outSol						= outKFolder + "/ilp_solution.txt";
+			string outSubnetworks				= outKFolder + "/subnetworksOverview.txt";
+			string outDistributionSize			= outKFolder + "/subnetwork_sizes.txt";
+			string outDistributionRecurrence	= outKFolder + "/subnetwork_recurrence.txt";
+			string outSubnFolder				= outKFolder + "/subnetworks";
+			string outCoveredSamples			= outKFolder + "/coveredSamples.txt";
+			sprintf(command, "mkdir -p %s", outSubnFolder.c_str());
+			system(command);
+			fill(selected.begin(), selected.end(), 0);
+			bool solved = true;
+			// Solutions that are not written by a MIP backend list the selected X columns
+			auto writeSelection = [&](const char * method, llu numCovered) {
+				FILE * foutSol = fopen(outSol.c_str(), "w");
+				fprintf(foutSol, "%s solution covering %llu nodes with the X columns\n", method, numCovered);
+				for (llu i = 0; i < numX; i++) {
+					if (selected[i]) fprintf(foutSol, "%llu\n", i);
+				}
+				fclose(foutSol);
+			};
+			if (strcmp(solverName, "greedy") == 0) {
+				fprintf(stderr, "\tRunning the greedy heuristic to find %d subnetworks that cover as many of the remaining nodes as possible.\n", K);
+				writeSelection("Greedy", selectGreedy(problem, selected));
+			}
+			else if (blocks.size() > 1) {
+				llu largestBlock = 0;
+				for (const CoverBlock & block : blocks)
+					largestBlock = max(largestBlock, llu(block.columns.size()));
+				fprintf(stderr, "\tRunning ILP on %llu independent blocks, the largest with %llu of the %llu subnetworks, to find %d subnetworks that cover as many of the remaining nodes as possible.\n", llu(blocks.size()), largestBlock, numX, K);
+				if (!blockSelection)
+					blockSelection = new BlockSelection(problem, blocks, weight, solverName, Ks.back(), strcmp(modelFormat, "none") ? outBlockModel.c_str() : NULL);
+				llu numCovered = 0;
+				solved = blockSelection->select(problem, selected, numCovered);
+				if (solved)
+					writeSelection("Block", numCovered);
+			}
+			else {
+				fprintf(stderr, "\tRunning ILP to find %d subnetworks that cover as many of the remaining nodes as possible.\n", K);
+				vector< vector<char> > starts;
+				if (greedyStart) {
+					starts.push_back(vector<char>(numX, 0));
+					selectGreedy(problem, starts.back());
+				}
+				if (!previous.empty())
+					starts.push_back(previous);
+				if (!solver) {
+					solver = createMipSolver(solverName, true);
+					budgetRow = buildMipModel(problem, *solver);
+					if (strcmp(modelFormat, "none")) {
+						solver->writeModel(outModel.c_str());
+						fprintf(stderr, "ILP model file written to '%s'.\n", outModel.c_str());
+					}
+				}
+				solved = selectWithMip(problem, *solver, budgetRow, outSol.c_str(), starts, selected);
+			}
+			if (solved)
+				previous = selected;
+			else
+				previous.clear();
+			if (!solved)
+				fprintf(stderr, "No solution was found within the time limit.\n");
+			else {
+				fprintf(stderr, "Solution file written to '%s'.\n", outSol.c_str());
+				vector<int> subnetworksizes;
+				vector<int> subnetworkrecurrence;
+				FILE * fout = fopen(outSubnetworks.c_str(), "w");
+				unordered_set<int> subnetworkNodes;
+				vector<int> visited(G.V, 0);
+				llu visitedIdx = 0;
+				unordered_set<int> samplesWithCoveredNodes;
+				for (llu i = 0, subnIdx = 0; i < numX; i++) {
+					if (selected[i]) {
+						SubnetworkView subnetInfo = properSubgraph(columnSubgraph[i]);
+						subnIdx++;
+						fprintf(fout, "Subnetwork\t%llu\n", subnIdx);
+						subnetInfo.print(colourPlanes, samples, alterations, G.chrArm, G.nodeNames, fout);
+						fprintf(fout, "\n");
+						char filename[1000];
+						sprintf(filename, "%s/%llu.edges", outSubnFolder.c_str(), subnIdx);
+						FILE * foutEdges = fopen(filename, "w");
+						sprintf(filename, "%s/%llu.adj", outSubnFolder.c_str(), subnIdx);
+						FILE * foutAdj = fopen(filename, "w");
+						sprintf(filename, "%s/%llu.nodes", outSubnFolder.c_str(), subnIdx);
+						FILE * foutNodes = fopen(filename, "w");
+						sprintf(filename, "%s/%llu.samples", outSubnFolder.c_str(), subnIdx);
+						FILE * foutSamples = fopen(filename, "w");
+						subnetworkNodes.clear();
+						const int * subnetNodes = subnetInfo.nodes;
+						const int * subnetNodesEnd = subnetInfo.nodes + subnetInfo.size;
+						for (const int * node = subnetNodes; node != subnetNodesEnd; node++) {
+							subnetworkNodes.insert(*node);
+						}
+						for (int sampleIdx = 0; sampleIdx < numPatients; sampleIdx++) {
+							if (subnetInfo.hasSample(sampleIdx)) {
+								samplesWithCoveredNodes.insert(sampleIdx);
+								fprintf(foutSamples, "%s\n", samples.names[sampleIdx].c_str());
+							}
+						}
+						for (const int * node = subnetNodes; node != subnetNodesEnd; node++) {
+							int nodeIdx = *node;
+							visitedIdx++;
+							for (int edgeIdx = 0; edgeIdx < G.degree(nodeIdx); edgeIdx++) {
+								int neighbour = G.neighbours(nodeIdx)[edgeIdx];
+								if (subnetworkNodes.count(neighbour)) {
+									fprintf(foutEdges, "%s %s\n", G.nodeNames[nodeIdx].c_str(), G.nodeNames[neighbour].c_str());
+									visited[neighbour] = visitedIdx;
+								}
+							}
+							for (const int * node2 = subnetNodes; node2 != subnetNodesEnd; node2++) {
+								int nodeIdx2 = *node2;
+								if (nodeIdx != nodeIdx2 && visited[nodeIdx2] == visitedIdx)
+									fprintf(foutAdj, "1 ");
+								else
+									fprintf(foutAdj, "0 ");
+							}
+							fprintf(foutAdj, "\n");
+							fprintf(foutNodes, "%s\n", G.nodeNames[nodeIdx].c_str());
+						}
+						fclose(foutEdges);
+						fclose(foutAdj);
+						fclose(foutNodes);
+						fclose(foutSamples);
+						subnetworksizes.push_back(subnetInfo.size);
+						subnetworkrecurrence.push_back(subnetInfo.numSamples());
+					}
 				}
-				Bitmask tempmask(subnetInfo->samples);
-				while (tempmask.getSize()) {
-					int sampleIdx = tempmask.extractLowestOrderSetBitIndex();
-					samplesWithCoveredNodes.insert(sampleIdx);
+				fclose(fout);
+				fprintf(stderr, "Subnetwork information written to '%s'.\n", outSubnetworks.c_str());
+				fprintf(stderr, "Out of %d samples with nodes that could be covered, %d samples support one of the chosen subnetworks.\n", samplesWithNodesThatCanBeCovered.size(), samplesWithCoveredNodes.size());
+				foutSamples = fopen(outCoveredSamples.c_str(), "w");
+				for (int sampleIdx : samplesWithCoveredNodes) {
 					fprintf(foutSamples, "%s\n", samples.names[sampleIdx].c_str());
 				}
-				for (int nodeIdx : subnetInfo -> nodes) {
-					visitedIdx++;
-					for (int edgeIdx = 0; edgeIdx < G.NSize[nodeIdx]; edgeIdx++) {
-						int neighbour = G.N[nodeIdx][edgeIdx];
-						if (subnetworkNodes.count(neighbour)) {
-							fprintf(foutEdges, "%s %s\n", G.nodeNames[nodeIdx].c_str(), G.nodeNames[neighbour].c_str());
-							visited[neighbour] = visitedIdx;
+				fclose(foutSamples);
+				// sort(subnetworksizes.begin(), subnetworksizes.end());
+				// sort(subnetworkrecurrence.begin(), subnetworkrecurrence.end());
+				fout = fopen(outDistributionSize.c_str(), "w");
+				for (int i = 0; i < subnetworksizes.size(); i++) fprintf(fout, "%d\n", subnetworksizes[i]);
+				fclose(fout);
+				fout = fopen(outDistributionRecurrence.c_str(), "w");
+				for (int i = 0; i < subnetworkrecurrence.size(); i++) fprintf(fout, "%d\n", subnetworkrecurrence[i]);
+				fclose(fout);/**/
+			}
+		}
+		delete solver;
+		delete blockSelection;
+	}
+}
+
+/*
+	A subnetwork found by the pricing of the column generation.
+*/
+struct PricedSubnetwork {
+	vector<int> nodes;
+	vector<unsigned char> colours;
+	vector<llu> exactBits;		// Samples in which every node has its colour
+	vector<llu> sampleBits;		// The same with the samples added by the error rate
+	int numExact;
+	int numSamples;
+	double value;				// Sum of the prices of the pairs it covers
+	vector<llu> key;			// Its (node, colour) pairs, see colouredNodeSet
+};
+
+// The (node, colour) pairs of a subnetwork as nodeIdx << 8 | colourIdx, in increasing order, which identifies it whatever the order its nodes were added in
+vector<llu> colouredNodeSet(const int * nodes, const unsigned char * colours, int size) {
+	vector<llu> key(size);
+	for (int j = 0; j < size; j++)
+		key[j] = llu(nodes[j]) << 8 | colours[j];
+	sort(key.begin(), key.end());
+	return key;
+}
+
+struct ColouredNodeSetHasher {
+	std::size_t operator()(const vector<llu> & Q) const {
+		return bitmaskKernels.hash(Q.data(), Q.size());
+	}
+};
+
+/*
+	Column generation, which grows the candidate subnetworks from the pool in the levels instead of enumerating all of them up to the size of the largest level. The pool holds all of them up to enumeratedSize nodes, so only larger ones are generated.
+	The master problem is the LP relaxation of the selection with a budget of K subnetworks and a C column per (sample, node) pair of the seeds, weighted by its seeds. Its duals price the pairs and the budget: a subnetwork improves the LP if the prices of the pairs it covers add up to more than the price of the budget.
+	Such subnetworks are searched for in the coloured components of every sample (STAGE 1) by a beam search, which grows them one coloured neighbour at a time and keeps the beamWidth most valuable ones of every size. The most valuable new one of every component is appended to its level, with the samples added by the error rate, and to the master problem.
+	The first round prices every pair with its number of seeds instead, which extends the pool greedily. Rounds go on until one with the LP adds nothing or the deadline is reached. The search is a heuristic, so the LP optimum over the pool is not guaranteed to be the one over all subnetworks.
+*/
+void generateColumns(vector<CandidateLevel> & candidateSubnetworks, Subgraph *** CC, int * CC_count, int enumeratedSize, int t, int K, double errorRate, int minColours, int threads, time_t deadline, const char * solverName, const string & spillPath) {
+	const int beamWidth = 16;
+	const double tolerance = 1e-6;
+	const int numPatients = samples.indices.size();
+	const int S = candidateSubnetworks.size();
+	const int len = candidateSubnetworks[0].len;
+	const bool extend = errorRate >= 1.0/S;
+	clock_t timerStart = clock();
+
+	// The rows of the master problem are the pairs of the seeds, followed by the budget row
+	NodeCoverIndex pairIndex;
+	llu numPairs = pairIndex.numberPairs();
+	vector<int> weight(numPairs, 0);
+	for (llu k = 0; k < subnetworkSeeds.size(); k++)
+		weight[ pairIndex.seedPair[k] ]++;
+	vector<int> rowOfPair(numPairs, -1);
+	vector<llu> rowPairs;
+	for (llu p = 0; p < numPairs; p++) {
+		if (weight[p]) {
+			rowOfPair[p] = rowPairs.size();
+			rowPairs.push_back(p);
+		}
+	}
+	int numRows = rowPairs.size();
+	int budgetRow = numRows;
+	MipSolver * master = createMipSolver(solverName, false);
+	master->relax();
+	{
+		vector<double> objective(numRows);
+		vector<int> rowStart(numRows), rowColumns(numRows);
+		vector<double> rowValues(numRows, -1);
+		for (int j = 0; j < numRows; j++) {
+			objective[j] = weight[ rowPairs[j] ];
+			rowStart[j] = rowColumns[j] = j;
+		}
+		master->addBinaryColumns(numRows, objective.data());
+		// C[j] <= sum of X over the subnetworks that cover pair j, whose columns are added below
+		master->addRows(numRows, rowStart.data(), numRows, rowColumns.data(), rowValues.data(), 'G', 0);
+		int emptyRow = 0;
+		master->addRows(1, &emptyRow, 0, rowColumns.data(), rowValues.data(), 'L', K);
+	}
+	const llu columnBatchNonzeros = 1 << 24;
+	vector<int> columnStart, columnRows;
+	vector<double> columnValues;
+	int numColumns = 0;
+	auto flushColumns = [&]() {
+		if (columnStart.empty()) return;
+		master->addBinaryColumns(columnStart.size(), NULL, columnStart.data(), columnRows.size(), columnRows.data(), columnValues.data());
+		numColumns += columnStart.size();
+		columnStart.clear();
+		columnRows.clear();
+		columnValues.clear();
+	};
+	auto addColumn = [&](const int * nodes, int size, const llu * sampleBits) {
+		if (columnRows.size() > columnBatchNonzeros)
+			flushColumns();
+		columnStart.push_back(columnRows.size());
+		pairIndex.forEachPair(nodes, size, sampleBits, [&](llu p) {
+			if (rowOfPair[p] >= 0)
+				columnRows.push_back(rowOfPair[p]);
+		});
+		columnRows.push_back(budgetRow);
+		columnValues.resize(columnRows.size(), 1);
+	};
+	unordered_set< vector<llu>, ColouredNodeSetHasher > known;	// The subnetworks in the pool
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++) {
+		CandidateLevel & level = candidateSubnetworks[sizeIdx];
+		for (llu i = 0; i < level.count(); i++) {
+			known.insert(colouredNodeSet(level.nodesOf(i), level.coloursOf(i), level.size));
+			addColumn(level.nodesOf(i), level.size, level.samplesOf(i));
+		}
+	}
+	flushColumns();
+	fprintf(stderr, "Generating subnetworks of up to %d nodes from a pool of %d, with an LP of %d pairs.\n", S, numColumns, numRows);
+
+	vector<double> price(numPairs, 0);
+	double budgetPrice = 0;
+	for (llu p = 0; p < numPairs; p++)
+		price[p] = weight[p];
+	vector<double> duals(numRows + 1);
+	double bound = 0;
+	llu numGenerated = 0;
+	vector< vector<PricedSubnetwork> > found(numPatients);	// The new subnetworks of every sample
+	for (int round = 0; ; round++) {
+		if (round > 0) {
+			if (!master->solveRelaxation(threads, max(1, int(deadline - time(NULL))), numRows + 1, duals.data(), bound)) {
+				fprintf(stderr, "\tThe LP relaxation was not solved within the time limit.\n");
+				break;
+			}
+			// Covering a pair can only raise the objective and so can a larger budget, so the shadow prices of the pair rows and of the budget row are nonnegative.
+			// The backends report them with opposite sign conventions for these rows, but all of them as the change of the objective per unit of right-hand side, so the prices are their magnitudes.
+			for (int j = 0; j < numRows; j++)
+				price[ rowPairs[j] ] = fabs(duals[j]);
+			budgetPrice = fabs(duals[budgetRow]);
+		}
+
+		// Pricing, sample after sample
+		atomic<int> nextSample(0);
+		runInParallel(threads, [&](int threadIdx) {
+			vector<char> inComponent(G.V, 0);
+			vector<int> localIdx(G.V, -1);
+			vector<PricedSubnetwork> beam, next;
+			unordered_set< vector<llu>, ColouredNodeSetHasher > seen;
+			auto evaluate = [&](PricedSubnetwork & candidate) {
+				int size = candidate.nodes.size();
+				candidate.numExact = countSetBitsFrom(candidate.exactBits.data(), len, 0);
+				candidate.sampleBits = candidate.exactBits;
+				candidate.numSamples = candidate.numExact;
+				if (extend) {
+					SubnetworkView view = { size, len, candidate.nodes.data(), candidate.colours.data(), candidate.sampleBits.data(), &candidate.numSamples };
+					view.extendSubnetworkWithError(colourPlanes, numPatients, errorRate);
+				}
+				candidate.value = 0;
+				pairIndex.forEachPair(candidate.nodes.data(), size, candidate.sampleBits.data(), [&](llu p) { candidate.value += price[p]; });
+			};
+			// Keeps the beamWidth most valuable subnetworks
+			auto prune = [&](vector<PricedSubnetwork> & states) {
+				auto moreValuable = [](const PricedSubnetwork & a, const PricedSubnetwork & b) { return a.value > b.value; };
+				if (int(states.size()) > beamWidth) {
+					nth_element(states.begin(), states.begin() + beamWidth, states.end(), moreValuable);
+					states.resize(beamWidth);
+				}
+			};
+			for (int sampleIdx = nextSample++; sampleIdx < numPatients; sampleIdx = nextSample++) {
+				found[sampleIdx].clear();
+				for (int CCIndex = 0; CCIndex < CC_count[sampleIdx]; CCIndex++) {
+					Subgraph * component = CC[sampleIdx][CCIndex];
+					PricedSubnetwork best;
+					best.value = budgetPrice + tolerance;
+					bool improving = false;
+					auto consider = [&](const PricedSubnetwork & candidate) {
+						if (int(candidate.nodes.size()) <= enumeratedSize || candidate.value <= best.value || known.count(candidate.key)) return;
+						llu colourMask = 0;
+						for (unsigned char colourIdx : candidate.colours)
+							colourMask |= llu(1) << colourIdx;
+						if (__builtin_popcountll(colourMask) < minColours) return;
+						best = candidate;
+						improving = true;
+					};
+					for (int i = 0; i < component->V; i++)
+						localIdx[ component->nodeNames[i] ] = i;
+					// Single nodes, with every colour they have in the sample
+					beam.clear();
+					for (int i = 0; i < component->V; i++) {
+						int nodeIdx = component->nodeNames[i];
+						for (llu rest = colourPlanes.coloursInSample(nodeIdx, sampleIdx) & edgeSupport.recurrentColours[nodeIdx]; rest; rest &= rest - 1) {
+							int colourIdx = __builtin_ctzll(rest);
+							PricedSubnetwork single;
+							single.nodes.assign(1, nodeIdx);
+							single.colours.assign(1, colourIdx);
+							single.exactBits.assign(len, 0);
+							copy(colourPlanes.plane(nodeIdx, colourIdx), colourPlanes.plane(nodeIdx, colourIdx) + colourPlanes.len, single.exactBits.begin());
+							single.key.assign(1, llu(nodeIdx) << 8 | colourIdx);
+							evaluate(single);
+							if (single.numExact < t) continue;
+							consider(single);
+							beam.push_back(move(single));
 						}
 					}
-					for (int nodeIdx2 : subnetInfo->nodes) {
-						if (nodeIdx != nodeIdx2 && visited[nodeIdx2] == visitedIdx)
-							fprintf(foutAdj, "1 ");
-						else
-							fprintf(foutAdj, "0 ");
+					prune(beam);
+					for (int size = 2; size <= S && !beam.empty(); size++) {
+						next.clear();
+						seen.clear();
+						for (const PricedSubnetwork & state : beam) {
+							for (int j = 0; j < size - 1; j++) {
+								int local = localIdx[ state.nodes[j] ];
+								for (int e = 0; e < component->degree(local); e++) {
+									int neighbour = component->nodeNames[ component->neighbours(local)[e] ];
+									if (find(state.nodes.begin(), state.nodes.end(), neighbour) != state.nodes.end()) continue;
+									for (llu rest = colourPlanes.coloursInSample(neighbour, sampleIdx) & edgeSupport.recurrentColours[neighbour]; rest; rest &= rest - 1) {
+										int colourIdx = __builtin_ctzll(rest);
+										vector<llu> key = state.key;
+										llu pair = llu(neighbour) << 8 | colourIdx;
+										key.insert(upper_bound(key.begin(), key.end(), pair), pair);
+										if (!seen.insert(key).second) continue;
+										const llu * plane = colourPlanes.plane(neighbour, colourIdx);
+										PricedSubnetwork grown = state;
+										grown.nodes.push_back(neighbour);
+										grown.colours.push_back(colourIdx);
+										for (int w = 0; w < colourPlanes.len; w++)
+											grown.exactBits[w] &= plane[w];
+										grown.key.swap(key);
+										if (countSetBitsFrom(grown.exactBits.data(), len, 0) < t) continue;
+										evaluate(grown);
+										consider(grown);
+										next.push_back(move(grown));
+									}
+								}
+							}
+						}
+						prune(next);
+						swap(beam, next);
 					}
-					fprintf(foutAdj, "\n");
-					fprintf(foutNodes, "%s\n", G.nodeNames[nodeIdx].c_str());
+					for (int i = 0; i < component->V; i++)
+						localIdx[ component->nodeNames[i] ] = -1;
+					if (improving)
+						found[sampleIdx].push_back(move(best));
 				}
-				fclose(foutEdges);
-				fclose(foutAdj);
-				fclose(foutNodes);
-				fclose(foutSamples);
-				subnetworksizes.push_back(subnetInfo->nodes.size());
-				subnetworkrecurrence.push_back(subnetInfo->numSamples());
+			}
+		});
+
+		// The new subnetworks are appended in sample order, once each
+		llu numNew = 0;
+		for (int sampleIdx = 0; sampleIdx < numPatients; sampleIdx++) {
+			for (PricedSubnetwork & subnetwork : found[sampleIdx]) {
+				if (!known.insert(subnetwork.key).second) continue;
+				int size = subnetwork.nodes.size();
+				candidateSubnetworks[size - 1].append(subnetwork.nodes.data(), subnetwork.colours.data(), subnetwork.sampleBits.data(), subnetwork.numSamples, subnetwork.numExact, sampleIdx);
+				addColumn(subnetwork.nodes.data(), size, subnetwork.sampleBits.data());
+				numNew++;
 			}
 		}
-		fclose(fout);
-		fprintf(stderr, "Subnetwork information written to '%s'.\n", outSubnetworks.c_str());
-		fprintf(stderr, "Out of %d samples with nodes that could be covered, %d samples support one of the chosen subnetworks.\n", samplesWithNodesThatCanBeCovered.size(), samplesWithCoveredNodes.size());
-		foutSamples = fopen(outCoveredSamples.c_str(), "w");
-		for (int sampleIdx : samplesWithCoveredNodes) {
-			fprintf(foutSamples, "%s\n", samples.names[sampleIdx].c_str());
+		flushColumns();
+		numGenerated += numNew;
+		if (round == 0)
+			fprintf(stderr, "\tExtended the pool greedily with %llu subnetworks.\n", numNew);
+		else
+			fprintf(stderr, "\tRound %d: the LP relaxation covers %.1lf nodes with %d subnetworks, and %llu new subnetworks improve it.\n", round, bound, K, numNew);
+		if (numNew == 0 && round > 0)
+			break;
+		if (time(NULL) >= deadline) {
+			fprintf(stderr, "\tThe time limit was reached, so no more subnetworks are priced.\n");
+			break;
 		}
-		fclose(foutSamples);
-		// sort(subnetworksizes.begin(), subnetworksizes.end());
-		// sort(subnetworkrecurrence.begin(), subnetworkrecurrence.end());
-		fout = fopen(outDistributionSize.c_str(), "w");
-		for (int i = 0; i < subnetworksizes.size(); i++) fprintf(fout, "%d\n", subnetworksizes[i]);
-		fclose(fout);
-		fout = fopen(outDistributionRecurrence.c_str(), "w");
-		for (int i = 0; i < subnetworkrecurrence.size(); i++) fprintf(fout, "%d\n", subnetworkrecurrence[i]);
-		fclose(fout);/**/
-	}
-	catch (IloException &ex) {}
-
-	for (int i = 0; i < samples.indices.size(); i++) {
-		delete [] node_CCIndex[i];
+	}
+	delete master;
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+		candidateSubnetworks[sizeIdx].seal(spillPath + "_s" + to_string(sizeIdx + 1));
+	fprintf(stderr, "Column generation added %llu subnetworks, for a pool of %d. (%.2lf seconds)\n", numGenerated, numColumns, double(clock() - timerStart) / CLOCKS_PER_SEC);
+}
+
+/*
+	The main function that preprocesses the data and runs the CPLEX ILP solver, for a given sample bitmask type.
+*/
+template <class Mask>
+void runSolverWithMask(int S, const vector<int> & ts, const vector<int> & Ks, double errorRate, const char * folderName, int threads, int seconds, int minColours, bool canonicalSeeds, llu memoryBudget, const char * modelFormat, int presolveLevel, const char * solverName, bool greedyStart, bool decompose, int columnGeneration) {
+	fprintf(stderr, "Using %s bitmask kernels.\n", bitmaskKernels.name);
+	int t = ts[0];	// Candidates are enumerated for the lowest threshold
+	int workerThreads = (threads > 0) ? threads : max(1u, thread::hardware_concurrency());
+	setMipSolverThreads(workerThreads);
+
+	//
+	//	STAGE 0: Indexing the samples that support every pair of coloured neighbours, keeping only the pairs that occur in at least 't' patients.
+	//
+	buildEdgeSupportIndex(t, workerThreads);
+	// A node can be part of a candidate in a sample only with a colour that it has in at least 't' patients, and an edge only if its coloured endpoints occur together in at least 't' patients
+	auto isRecurrentIn = [&](int nodeIdx, int sampleIdx) {
+		return edgeSupport.recurrentColours[nodeIdx] && (edgeSupport.recurrentColours[nodeIdx] & colourPlanes.coloursInSample(nodeIdx, sampleIdx));
+	};
+
+	/*
+		STAGE 1: Identification of connected components among the coloured nodes in the PPI network, over the edges supported in at least 't' patients.
+		Purpose: Minimization of the flow network size for each possible seed.
+	*/
+	fprintf(stderr, "Finding coloured patient-specific connected components... ");
+	int timerStart = clock();
+	const int numSamples = samples.indices.size();
+	// The nodes that can be part of a candidate in each sample, in increasing order, are sampleNodes[sampleNodeStart[sampleIdx]] .. sampleNodes[sampleNodeStart[sampleIdx + 1] - 1]
+	// sampleNodeCC holds the index of their connected coloured component in the sample, so the storage grows with the number of alterations rather than with samples * nodes
+	llu * sampleNodeStart = new llu [numSamples + 1];
+	memset(sampleNodeStart, 0, sizeof(sampleNodeStart[0]) * (numSamples + 1));
+	int * sampleNodes = NULL;
+	for (int pass = 0; pass < 2; pass++) {	// Counting the nodes of every sample, then filling them in
+		if (pass == 1) {
+			for (int sampleIdx = 0; sampleIdx < numSamples; sampleIdx++)
+				sampleNodeStart[sampleIdx + 1] += sampleNodeStart[sampleIdx];
+			sampleNodes = new int [ sampleNodeStart[numSamples] ];
+		}
+		vector<llu> fill(sampleNodeStart, sampleNodeStart + numSamples);
+		for (int nodeIdx = 0; nodeIdx < G.V; nodeIdx++) {
+			if (!edgeSupport.recurrentColours[nodeIdx]) continue;
+			const llu * coloured = colourPlanes.coloured(nodeIdx);
+			for (int w = 0; w < colourPlanes.len; w++) {
+				for (llu rest = coloured[w]; rest; rest &= rest - 1) {
+					int sampleIdx = 64 * w + __builtin_ctzll(rest);
+					if (!isRecurrentIn(nodeIdx, sampleIdx)) continue;
+					if (pass == 0)
+						sampleNodeStart[sampleIdx + 1]++;
+					else
+						sampleNodes[ fill[sampleIdx]++ ] = nodeIdx;
+				}
+			}
+		}
+	}
+	int * sampleNodeCC = new int [ sampleNodeStart[numSamples] ];
+	int * CC_count = new int [numSamples];	// CC_count[sampleIdx] = numberOfConnectedColouredComponents
+	Subgraph *** CC = new Subgraph ** [numSamples];
+	atomic<int> nextSample(0);
+	runInParallel(workerThreads, [&](int threadIdx) {
+		vector<int> slot(G.V, -1);	// slot[nodeIdx] = position of the node among the nodes of the current sample, -1 if it has none
+		vector<int> localIdx(G.V, -1);
+		vector<int> nodeStack, CCNodes, CCStart;
+		for (int sampleIdx = nextSample++; sampleIdx < numSamples; sampleIdx = nextSample++) {
+			const int * nodes = sampleNodes + sampleNodeStart[sampleIdx];
+			int * nodeCC = sampleNodeCC + sampleNodeStart[sampleIdx];
+			int numNodes = sampleNodeStart[sampleIdx + 1] - sampleNodeStart[sampleIdx];
+			for (int k = 0; k < numNodes; k++) {
+				slot[ nodes[k] ] = k;
+				nodeCC[k] = -1;
+			}
+			int & num_of_CCs = CC_count[sampleIdx];	// Number of connected components
+			num_of_CCs = 0;
+			nodeStack.resize(numNodes);
+			int nodeStackSize = 0;
+			for (int k = 0; k < numNodes; k++) {
+				if (nodeCC[k] != -1) continue;	// node is already assigned to a connected component
+				nodeCC[k] = num_of_CCs++;
+				nodeStack[nodeStackSize++] = k;
+				while (nodeStackSize) {
+					int nodeSlot = nodeStack[--nodeStackSize];
+					int node = nodes[nodeSlot];
+					for (int j1 = 0; j1 < G.degree(node); j1++) {
+						int neighbourSlot = slot[ G.neighbours(node)[j1] ];
+						if (neighbourSlot != -1 && nodeCC[neighbourSlot] == -1 && edgeSupport.isSupportedIn(node, j1, sampleIdx)) {	// neighbour is coloured, joined by a supported edge and not assigned to a connected component
+							nodeCC[neighbourSlot] = nodeCC[nodeSlot];
+							nodeStack[nodeStackSize++] = neighbourSlot;
+						}
+					}
+				}
+			}
+			/*****************************************************************************************************************************
+			 * Computed number of connected coloured components in the sample. (CC_count[sampleIdx])									 *
+			 * For every node of the sample, assigned index of the connected coloured component it belongs to in the sample. (nodeCC)	 *
+			 *****************************************************************************************************************************/
+			CCStart.assign(num_of_CCs + 1, 0);
+			for (int k = 0; k < numNodes; k++) CCStart[ nodeCC[k] ]++;
+			for (int i = 1; i < num_of_CCs; i++) CCStart[i] += CCStart[i - 1];
+			CCStart[num_of_CCs] = numNodes;
+			CCNodes.resize(numNodes);
+			for (int k = 0; k < numNodes; k++) CCNodes[ --CCStart[ nodeCC[k] ] ] = nodes[k];
+			/***************************************************************************************
+			 * Partitioned nodes of the sample network based on coloured connected component index *
+			 ***************************************************************************************/
+			CC[sampleIdx] = new Subgraph * [num_of_CCs];
+			for (int CCIndex = 0; CCIndex < num_of_CCs; CCIndex++)
+				CC[sampleIdx][CCIndex] = new Subgraph(&G, CCNodes.data() + CCStart[CCIndex], CCStart[CCIndex + 1] - CCStart[CCIndex], localIdx, [&](int node, int k) { return edgeSupport.isSupportedIn(node, k, sampleIdx); });
+			/****************************************************************
+			 * Constructed subgraphs based on connected coloured components *
+			 ****************************************************************/
+			for (int k = 0; k < numNodes; k++)
+				slot[ nodes[k] ] = -1;
+		}
+	});
+	fprintf(stderr, "done. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+
+	// Allocation
+	const int numPatients = samples.indices.size();
+	const int maskWords = sampleMaskWords(numPatients);
+	vector<CandidateLevel> candidateSubnetworks;	// candidateSubnetworks[sizeIdx] holds all candidates with sizeIdx + 1 nodes
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+		candidateSubnetworks.push_back(CandidateLevel(sizeIdx + 1, maskWords));
+
+	//
+	//	STAGES 2 and 3: Enumeration of the candidate subnetworks of up to S nodes, grown from the single-node networks of the coloured nodes of every seed sample.
+	//	STAGE 4 is fused into it: candidates that are contained in a larger one with the same patients, or that have fewer than 'minColours' colours, are counted but not stored.
+	//	With column generation, only the ones of up to 'columnGeneration' nodes are enumerated, and the larger ones are generated after STAGE 5.
+	//
+	int enumeratedSize = columnGeneration ? min(S, columnGeneration) : S;
+	llu totalNumSubgraphs	= 0;
+	EnumerationStats stats;
+	fprintf(stderr, "Constructing all candidate subnetworks of up to %d nodes...\n", enumeratedSize); timerStart = clock();
+	enumerateCandidates<Mask>(candidateSubnetworks, CC, CC_count, enumeratedSize, t, minColours, workerThreads, canonicalSeeds, memoryBudget, string(folderName) + "/spill", stats);
+	for (int sizeIdx = 0; sizeIdx < enumeratedSize; sizeIdx++) {
+		fprintf(stderr, "\r%llu subgraphs of size %d.\n", stats.numFound[sizeIdx], sizeIdx + 1);
+		totalNumSubgraphs += stats.numFound[sizeIdx];
+	}
+	fprintf(stderr, "Constructed all candidate subnetworks. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+	fprintf(stderr, "Total amount of subgraphs of all sizes up to %d which are recurrent in at least %d patients is %llu.\n", enumeratedSize, t, totalNumSubgraphs);
+	fprintf(stderr, "%llu subgraphs are contained in a subgraph of larger size with the same patients, and are discarded.\n", stats.numContained);
+	fprintf(stderr, "%llu subgraphs were considered.\n", totalNumSubgraphs - stats.numContained);
+	for (int i = 1; i <= alterations.indices.size(); i++) {
+		fprintf(stderr, "\t%llu subnetworks have %d colour%s among their nodes.\n", stats.colourCount[i], i, i > 1 ? "s" : "");
+	}
+	if (minColours > 1) {
+		fprintf(stderr, "%llu subgraphs do not have at least %d differently-coloured nodes, and are discarded.\n", stats.numImproperlyColoured, minColours);
+	}
+
+	// The proper subgraphs are the stored candidates, numbered level after level: the ones of candidateSubnetworks[sizeIdx] are properLevelStart[sizeIdx] .. properLevelStart[sizeIdx + 1] - 1
+	vector<llu> properLevelStart(S + 1, 0);
+	for (int sizeIdx = 0; sizeIdx < S; sizeIdx++)
+		properLevelStart[sizeIdx + 1] = properLevelStart[sizeIdx] + candidateSubnetworks[sizeIdx].count();
+	llu numProperSubgraphs = properLevelStart[S];
+	// Returns the view of the i-th proper subgraph
+	auto properSubgraph = [&](llu i) {
+		int sizeIdx = upper_bound(properLevelStart.begin(), properLevelStart.end(), i) - properLevelStart.begin() - 1;
+		return candidateSubnetworks[sizeIdx].view(i - properLevelStart[sizeIdx]);
+	};
+	fprintf(stderr, "%llu proper subgraphs are considered.\n", numProperSubgraphs);
+
+	//
+	//	STAGE 5: Extending candidate subnetworks to include samples in which there aren't all exact matches, but there aren't colour conflicts either. 
+	//
+
+	if (errorRate >= 1.0/S) {
+		timerStart = clock();
+		fprintf(stderr, "Extending subnetworks to include %d%% errors...\n", int(errorRate * 100));
+		// Threads grab chunks of proper subgraphs from a shared counter, and thread 0 reports the progress
+		const llu chunkSize = 1024;
+		atomic<llu> nextChunk(0);
+		vector<llu> threadExtended(workerThreads, 0), threadAdded(workerThreads, 0);
+		runInParallel(workerThreads, [&](int threadIdx) {
+			int lastProg = 0;
+			for (llu chunkStart = chunkSize * nextChunk++; chunkStart < numProperSubgraphs; chunkStart = chunkSize * nextChunk++) {
+				for (llu i = chunkStart; i < min(chunkStart + chunkSize, numProperSubgraphs); i++) {
+					SubnetworkView subnetInfo = properSubgraph(i);
+					int numSamplesBefore = subnetInfo.numSamples();
+					subnetInfo.extendSubnetworkWithError(colourPlanes, numPatients, errorRate);
+					int numSamplesAfter = subnetInfo.numSamples();
+					if (numSamplesAfter > numSamplesBefore) {
+						threadExtended[threadIdx]++;
+						threadAdded[threadIdx] += numSamplesAfter - numSamplesBefore;
+					}
+				}
+				int progress = 1000 * double(min(chunkStart + chunkSize, numProperSubgraphs)) / double(numProperSubgraphs);
+				if (threadIdx == 0 && progress > lastProg) {
+					fprintf(stderr, "\r%.1lf%%", double(progress)/10.0);
+					lastProg = progress;
+				}
+			}
+		});
+		llu numSubnetworksExtended = 0;
+		llu numSamplesAdded = 0;
+		for (int threadIdx = 0; threadIdx < workerThreads; threadIdx++) {
+			numSubnetworksExtended += threadExtended[threadIdx];
+			numSamplesAdded += threadAdded[threadIdx];
+		}
+		fprintf(stderr, "\rDone. (%.2lf seconds)\n", double(clock() - timerStart) / CLOCKS_PER_SEC);
+		fprintf(stderr, "%llu subnetworks have been extended.\n", numSubnetworksExtended);
+		fprintf(stderr, "Average number of samples added is %.1lf\n", double(numSamplesAdded) / numSubnetworksExtended);
+	}
+
+	// Column generation and the first selection share the time limit, and the pricing rounds stop halfway through it
+	time_t deadline = columnGeneration ? time(NULL) + seconds : 0;
+	if (columnGeneration)
+		generateColumns(candidateSubnetworks, CC, CC_count, enumeratedSize, t, Ks.back(), errorRate, minColours, workerThreads, deadline - seconds / 2, strcmp(solverName, "greedy") ? solverName : mipSolverNames[0].c_str(), string(folderName) + "/spill");
+	
+	//
+	//	STAGES 6 and on, for every threshold: the candidates that are recurrent in at least 'threshold' patients are the ones found for the lowest threshold with as many exact matches, so higher thresholds only filter them.
+	//
+	for (int threshold : ts) {
+		string outFolder = string(folderName);
+		if (ts.size() > 1) {
+			outFolder += "/t" + to_string(threshold);
+			llu numKept = 0;
+			// The candidates are filtered by their number of exact matches, which the extension leaves unchanged
+			for (int sizeIdx = 0; sizeIdx < S; sizeIdx++) {
+				CandidateLevel & level = candidateSubnetworks[sizeIdx];
+				vector<char> keep(level.count());
+				for (llu i = 0; i < level.count(); i++) {
+					keep[i] = level.exactCount[i] >= threshold;
+					numKept += keep[i];
+				}
+				level.filter(keep);
+			}
+			fprintf(stderr, "\n%llu proper subgraphs are recurrent in at least %d patients.\n", numKept, threshold);
+			char command[1000];
+			sprintf(command, "mkdir -p %s", outFolder.c_str());
+			system(command);
+		}
+		selectSubnetworks(candidateSubnetworks, threshold, Ks, outFolder.c_str(), workerThreads, seconds, deadline, modelFormat, presolveLevel, solverName, greedyStart, decompose);
+		deadline = 0;
+	}
+
+	for (int i = 0; i < numSamples; i++) {
 		for (int j = 0; j < CC_count[i]; j++) delete CC[i][j];
 		delete CC[i];
 	}
-	delete node_CCIndex;
+	delete [] sampleNodeStart;
+	delete [] sampleNodes;
+	delete [] sampleNodeCC;
 	delete [] CC_count;
 	delete CC;/**/
 }
 
+/*
+	Runs the solver with the narrowest sample bitmask that fits the cohort. Cohorts of more than 1024 samples use the heap-allocated Bitmask.
+*/
+void runSolver(int S, const vector<int> & ts, const vector<int> & Ks, double errorRate, const char * folderName, int threads, int seconds, int minColours, bool canonicalSeeds, llu memoryBudget, const char * modelFormat, int presolveLevel, const char * solverName, bool greedyStart, bool decompose, int columnGeneration) {
+	int words = sampleMaskWords(samples.indices.size());
+	if (words <= 16)
+		fprintf(stderr, "Using inline bitmasks of %d samples.\n", 64 * words);
+	switch (words) {
+		case 1:		runSolverWithMask< FixedBitmask<1> >(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+		case 2:		runSolverWithMask< FixedBitmask<2> >(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+		case 4:		runSolverWithMask< FixedBitmask<4> >(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+		case 8:		runSolverWithMask< FixedBitmask<8> >(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+		case 16:	runSolverWithMask< FixedBitmask<16> >(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+		default:	runSolverWithMask<Bitmask>(S, ts, Ks, errorRate, folderName, threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat, presolveLevel, solverName, greedyStart, decompose, columnGeneration); break;
+	}
+}
+
+/*
+	Parses a comma-separated list of positive integers, such as "10,25,50", into increasing order without repeats. Exits if a value is not a positive integer.
+*/
+vector<int> parseIntList(const string & text, char flag) {
+	vector<int> values;
+	for (size_t start = 0; start <= text.size(); ) {
+		size_t end = text.find(',', start);
+		if (end == string::npos) end = text.size();
+		int value = 0;
+		char rest = 0;
+		if (sscanf(text.substr(start, end - start).c_str(), "%d%c", &value, &rest) != 1 || value <= 0) {
+			fprintf(stderr, "\n< Error > Parameter '%c' expects positive integers separated by commas, not '%s'. Exiting program.\n", flag, text.c_str());
+			exit(0);
+		}
+		values.push_back(value);
+		start = end + 1;
+	}
+	sort(values.begin(), values.end());
+	values.erase(unique(values.begin(), values.end()), values.end());
+	return values;
+}
+
+/*
+	The values of a list in output folder names, joined by '-'.
+*/
+string joinIntList(const vector<int> & values) {
+	string label = to_string(values[0]);
+	for (size_t i = 1; i < values.size(); i++)
+		label += "-" + to_string(values[i]);
+	return label;
+}
+
 int main( int argc, char * argv[] ) {
 	printHeader( "MCSC ILP" );
 	// INPUT CHECK
 	if (argc <= 1) {
-		fprintf(stderr, "./mcsc -n [network] -l [alteration profiles] -c [chromosome information; optional] -r [min number of colours in subnetwork] -x [exclude genes; optional] -s [maximum subnetwork size] -t [minimum subgraph recurrence]  -k [number of subnetworks] -e [error; optional] -f [outputFolder] -d [threads] -h [time limit in seconds]\n\n");
+		fprintf(stderr, "./mcsc -n [network] -l [alteration profiles] -c [chromosome information; optional] -r [min number of colours in subnetwork] -x [exclude genes; optional] -s [maximum subnetwork size] -t [minimum subgraph recurrence]  -k [number of subnetworks] -e [error; optional] -f [outputFolder] -d [threads] -h [time limit in seconds] -u [grow subnetworks from canonical seeds only; optional] --memory-budget [GB of candidate subnetworks kept in memory; optional] --export-model [lp, sav or none; optional] --presolve [0, 1 or 2; optional] --solver [cplex, highs or greedy; optional] --greedy-start [start CPLEX from the greedy solution; optional] --blocks [solve independent blocks separately; optional] --column-generation [largest enumerated subnetwork size, larger ones are generated; optional]\n");
+		fprintf(stderr, "./mcsc -n [network] -l [alteration profiles] -c [chromosome information; optional] -x [exclude genes; optional] --build-snapshot [snapshot file]\n");
+		fprintf(stderr, "./mcsc --snapshot [snapshot file] -r ... -s ... -t ... -k ... -e ... -f ... -d ... -h ... -u ... (instead of -n, -l, -c and -x)\n\n");
 		return 0;
 	}
-	char consoleFlags[] = {'n', 'l', 's', 't', 'f', 'k', 'c', 'x', 'e', 'd', 'h', 'r', 0};
+	char consoleFlags[] = {'n', 'l', 's', 't', 'f', 'k', 'c', 'x', 'e', 'd', 'h', 'r', 'u', 0};
 	bool optional[200] = {};
 	optional['c'] = true;
 	optional['x'] = true;
 	optional['e'] = true;
+	optional['u'] = true;
 	unordered_map<char, string> consoleParameters;
+	unordered_map<string, string> longParameters;	// --build-snapshot, --snapshot, --memory-budget, --export-model, --presolve, --solver, --greedy-start, --blocks and --column-generation
 	for (int i = 1; i < argc; i++) {
-		if ( argv[i][0] == '-' && argv[i][1] && i + 1 < argc && argv[i + 1][0] != '-' ) {
+		if ( argv[i][0] == '-' && argv[i][1] == '-' && i + 1 < argc ) {
+			longParameters[ string(argv[i] + 2) ] = string( argv[i + 1] );
+			i++;
+		}
+		else if ( argv[i][0] == '-' && argv[i][1] && i + 1 < argc && argv[i + 1][0] != '-' ) {
 			consoleParameters[ argv[i][1] ] = string( argv[i + 1] );
 			i++;
 		}
 	}
+	bool buildSnapshot = longParameters.count("build-snapshot");
+	bool useSnapshot = longParameters.count("snapshot");
+	if (buildSnapshot) {	// Only the inputs are needed
+		for (char * ptrFlag = consoleFlags; *ptrFlag; ptrFlag++)
+			optional[*ptrFlag] = (*ptrFlag != 'n' && *ptrFlag != 'l');
+	}
+	if (useSnapshot) {
+		optional['n'] = true;
+		optional['l'] = true;
+		if (consoleParameters.count('n') || consoleParameters.count('l') || consoleParameters.count('c') || consoleParameters.count('x'))
+			fprintf(stderr, "Parameters -n, -l, -c and -x are ignored, as the input is read from the snapshot.\n");
+	}
 	for (char * ptrFlag = consoleFlags; *ptrFlag; ptrFlag++) {
 		if ( !optional[*ptrFlag] && !consoleParameters.count(*ptrFlag) ) {
 			fprintf(stderr, "\n< Error > Missing value for parameter '%c'. Exiting program.\n", *ptrFlag);
 			exit(0);
 		}
 	}
+	if (buildSnapshot) {
+		printHeader("Reading Input");
+		readUndirectedNetwork( consoleParameters['n'].c_str() );
+		if (consoleParameters.count('c'))
+			readChromosomeInfo( consoleParameters['c'].c_str() );
+		readAlterationProfiles( consoleParameters['l'].c_str() );
+		if (consoleParameters.count('x'))
+			readExcludeInfo( consoleParameters['x'].c_str() );
+		buildColourPlanes();
+		writeSnapshot( longParameters["build-snapshot"].c_str() );
+		return 0;
+	}
 	int maxSubnetworkSize;
-	int minSubnetworkRecurrence;
-	int K;
+	vector<int> minSubnetworkRecurrences;	// Thresholds of recurrence, in increasing order
+	vector<int> Ks;	// Numbers of subnetworks to select, in increasing order
 	double errorRate = 0;
 	int threads;
 	int seconds;
 	int minColours;
+	int canonicalSeeds = 0;
+	llu memoryBudget = 0;	// Bytes of candidate subnetworks kept in memory during enumeration, 0 for no limit
+	string modelFormat = "lp";	// Format of the exported ILP model: lp, sav (gzipped binary) or none
+	int presolveLevel = 1;		// 0 keeps all subgraphs, 1 merges identical coverage, 2 also removes dominated coverage
+	string solverName = mipSolverNames.empty() ? "greedy" : mipSolverNames[0];	// Selection backend: one of mipSolverNames or greedy
+	int greedyStart = 0;		// Whether the greedy selection is given to CPLEX as a MIP start
+	int decompose = 1;			// Whether the ILP is solved as independent blocks when it splits into several
+	int columnGeneration = 0;	// Largest size of the enumerated subnetworks when the larger ones are generated, 0 to enumerate all of them
 	char folderName[1000] = {};
 	sscanf(consoleParameters['s'].c_str(), "%d", &maxSubnetworkSize);
-	sscanf(consoleParameters['t'].c_str(), "%d", &minSubnetworkRecurrence);
-	sscanf(consoleParameters['k'].c_str(), "%d", &K);
+	if (maxSubnetworkSize > 64) {
+		fprintf(stderr, "\n< Error > The maximum subnetwork size is 64, as the nodes of a subnetwork are tracked in 64-bit masks. Exiting program.\n");
+		exit(0);
+	}
+	minSubnetworkRecurrences = parseIntList(consoleParameters['t'], 't');
+	Ks = parseIntList(consoleParameters['k'], 'k');
 	sscanf(consoleParameters['d'].c_str(), "%d", &threads);
 	sscanf(consoleParameters['h'].c_str(), "%d", &seconds);
 	sscanf(consoleParameters['r'].c_str(), "%d", &minColours);
@@ -1153,14 +3764,55 @@ int main( int argc, char * argv[] ) {
 		sscanf(consoleParameters['e'].c_str(), "%lf", &errorRate);
 		fprintf(stderr, "Error rate set to %.2lf\n", errorRate);
 	}
+	if (consoleParameters.count('u'))
+		sscanf(consoleParameters['u'].c_str(), "%d", &canonicalSeeds);
+	if (longParameters.count("memory-budget")) {
+		double gigabytes = 0;
+		sscanf(longParameters["memory-budget"].c_str(), "%lf", &gigabytes);
+		memoryBudget = llu(gigabytes * (1 << 30));
+		fprintf(stderr, "Candidate subnetworks beyond %.2lf GB are spilled to disk.\n", gigabytes);
+	}
+	if (longParameters.count("presolve"))
+		sscanf(longParameters["presolve"].c_str(), "%d", &presolveLevel);
+	if (longParameters.count("solver")) {
+		solverName = longParameters["solver"];
+		if (solverName != "greedy" && find(mipSolverNames.begin(), mipSolverNames.end(), solverName) == mipSolverNames.end()) {
+			string available = "greedy";
+			for (const string & name : mipSolverNames) available += ", " + name;
+			fprintf(stderr, "\n< Error > Solver '%s' is not available in this build (available: %s). Exiting program.\n", solverName.c_str(), available.c_str());
+			exit(0);
+		}
+	}
+	if (longParameters.count("greedy-start"))
+		sscanf(longParameters["greedy-start"].c_str(), "%d", &greedyStart);
+	if (longParameters.count("blocks"))
+		sscanf(longParameters["blocks"].c_str(), "%d", &decompose);
+	if (longParameters.count("column-generation")) {
+		sscanf(longParameters["column-generation"].c_str(), "%d", &columnGeneration);
+		if (columnGeneration && mipSolverNames.empty()) {
+			fprintf(stderr, "\n< Error > Column generation needs the LP relaxation, which this build has no solver for. Exiting program.\n");
+			exit(0);
+		}
+	}
+	if (longParameters.count("export-model")) {
+		modelFormat = longParameters["export-model"];
+		if (modelFormat != "lp" && modelFormat != "sav" && modelFormat != "none") {
+			fprintf(stderr, "\n< Error > Unknown model format '%s' (expected lp, sav or none). Exiting program.\n", modelFormat.c_str());
+			exit(0);
+		}
+		if (modelFormat == "sav" && solverName != "cplex") {
+			fprintf(stderr, "\n< Error > The sav model format is only written by CPLEX. Exiting program.\n");
+			exit(0);
+		}
+	}
 	sscanf(consoleParameters['f'].c_str(), "%s", folderName);
 	// Create directory structure for the output
 	char command[1000];
 	char fullFolder[1000];
 	if (consoleParameters.count('e'))
-		sprintf(fullFolder, "./%s_s%d_t%d_k%d_e%.2lf_r%d", ("output/" + string(folderName)).c_str(), maxSubnetworkSize, minSubnetworkRecurrence, K, errorRate, minColours);
+		sprintf(fullFolder, "./%s_s%d_t%s_k%s_e%.2lf_r%d", ("output/" + string(folderName)).c_str(), maxSubnetworkSize, joinIntList(minSubnetworkRecurrences).c_str(), joinIntList(Ks).c_str(), errorRate, minColours);
 	else 
-		sprintf(fullFolder, "./%s_s%d_t%d_k%d_r%d", ("output/" + string(folderName)).c_str(), maxSubnetworkSize, minSubnetworkRecurrence, K, minColours);
+		sprintf(fullFolder, "./%s_s%d_t%s_k%s_r%d", ("output/" + string(folderName)).c_str(), maxSubnetworkSize, joinIntList(minSubnetworkRecurrences).c_str(), joinIntList(Ks).c_str(), minColours);
 	string outFolder = string(fullFolder);
 	sprintf(command, "rm -f -r %s", outFolder.c_str());
 	system(command);
@@ -1169,13 +3821,18 @@ int main( int argc, char * argv[] ) {
 	string outLog = outFolder + "/run.log";
 	// freopen(outLog.c_str(), "w", stderr);
 	printHeader("Reading Input");
-	readUndirectedNetwork( consoleParameters['n'].c_str() );
-	if (consoleParameters.count('c'))
-		readChromosomeInfo( consoleParameters['c'].c_str() );
-	readAlterationProfiles( consoleParameters['l'].c_str() );
-	if (consoleParameters.count('x'))
-		readExcludeInfo( consoleParameters['x'].c_str() );
+	if (useSnapshot)
+		loadSnapshot( longParameters["snapshot"].c_str() );
+	else {
+		readUndirectedNetwork( consoleParameters['n'].c_str() );
+		if (consoleParameters.count('c'))
+			readChromosomeInfo( consoleParameters['c'].c_str() );
+		readAlterationProfiles( consoleParameters['l'].c_str() );
+		if (consoleParameters.count('x'))
+			readExcludeInfo( consoleParameters['x'].c_str() );
+		buildColourPlanes();
+	}
 	printHeader("Solving the problem");
-	runSolver(maxSubnetworkSize, minSubnetworkRecurrence, K, errorRate, outFolder.c_str(), threads, seconds, minColours);
+	runSolver(maxSubnetworkSize, minSubnetworkRecurrences, Ks, errorRate, outFolder.c_str(), threads, seconds, minColours, canonicalSeeds, memoryBudget, modelFormat.c_str(), presolveLevel, solverName.c_str(), greedyStart, decompose, columnGeneration);
 	return 0;
 }
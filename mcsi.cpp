@@ -1,5 +1,7 @@
 #include <cstdio>
+#include <cctype>
 #include <cstring>
+#include <string>
 #include <ctime>
 #include <unordered_map>
 #include <unordered_set>
@@ -10,6 +12,7 @@
 #include <algorithm>
 #include <vector>
 #include <utility>
+#include <zlib.h>
 using namespace std;
 
 typedef unsigned long long llu;
@@ -257,35 +260,89 @@ void readUndirectedNetwork(const char * filename) {
 			G.E / 2);
 }
 
-/* Reads the input -l parameter as a collection of "sample gene alterationType" triples, separated by whitespace. */
+/* Reads the input -l parameter as a collection of "sample gene alterationType" triples, separated by whitespace.
+ * The file is read in a single streaming pass and may be gzip-compressed. */
 void readAlterationProfiles(const char * filename, int init_) {
 	fprintf(stderr, "Reading the alteration profiles... ");
 	int timerStart = clock();
-	char sample[1000], gene[1000], alterationType[1000];
-	FILE * fin = NULL;
-	if (!(fin = fopen(filename, "r"))) {
+	gzFile fin = gzopen(filename, "rb");
+	if (!fin) {
 		fprintf(stderr,
 				"\n< Error > Cannot open file '%s'. Please make sure the file exists.\n",
 				filename);
 		exit(0);
 	}
-	while (fscanf(fin, "%s%s%s", sample, gene, alterationType) == 3) {
-		if (G.nodeIndices.find(string(gene)) == G.nodeIndices.end())
-			continue;
-		if (samples.indices.find(string(sample)) == samples.indices.end()) {
-			int idx = samples.indices.size();
-			samples.indices[string(sample)] = idx;
+	gzbuffer(fin, 1 << 20);
+	geneAlterations = new unordered_map<int, unsigned int> [G.V];
+	string fields[3]; // sample, gene, alteration type of the current row
+	int numFields = 0;
+	const int bufferSize = 1 << 24;
+	char * buffer = new char[bufferSize];
+	int bufferLen = 0;
+	for (bool atEnd = false; !atEnd;) {
+		int bytesRead = gzread(fin, buffer + bufferLen, bufferSize - bufferLen);
+		if (bytesRead < 0) {
+			fprintf(stderr,
+					"\n< Error > Cannot read file '%s'. The file may be corrupted.\n",
+					filename);
+			exit(0);
 		}
-		if (genes.indices.find(string(gene)) == genes.indices.end()) {
-			int idx = genes.indices.size();
-			genes.indices[string(gene)] = idx;
+		atEnd = (bytesRead == 0);
+		bufferLen += bytesRead;
+		int pos = 0, consumed = 0;
+		while (true) {
+			while (pos < bufferLen && isspace(buffer[pos]))
+				pos++;
+			int start = pos;
+			while (pos < bufferLen && !isspace(buffer[pos]))
+				pos++;
+			/* Stop at the end of the data, or at a word that may continue in the next chunk */
+			if (pos == start || (pos == bufferLen && !atEnd)) {
+				consumed = start;
+				break;
+			}
+			fields[numFields++].assign(buffer + start, pos - start);
+			if (numFields < 3)
+				continue;
+			numFields = 0;
+			unordered_map<string, int>::iterator nodeIt = G.nodeIndices.find(
+					fields[1]);
+			if (nodeIt == G.nodeIndices.end())
+				continue;
+			int geneIndex = nodeIt->second;
+			if (genes.indices.find(fields[1]) == genes.indices.end()) {
+				int idx = genes.indices.size();
+				genes.indices[fields[1]] = idx;
+			}
+			unordered_map<string, int>::iterator sampleIt = samples.indices.find(
+					fields[0]);
+			int sampleIndex;
+			if (sampleIt == samples.indices.end()) {
+				sampleIndex = samples.indices.size();
+				samples.indices[fields[0]] = sampleIndex;
+			} else
+				sampleIndex = sampleIt->second;
+			unordered_map<string, int>::iterator alterationIt =
+					alterations.indices.find(fields[2]);
+			int alterationIndex;
+			if (alterationIt == alterations.indices.end()) {
+				alterationIndex = alterations.indices.size();
+				alterations.indices[fields[2]] = alterationIndex;
+			} else
+				alterationIndex = alterationIt->second;
+			geneAlterations[geneIndex][sampleIndex] |= (1 << alterationIndex);
 		}
-		if (alterations.indices.find(string(alterationType))
-				== alterations.indices.end()) {
-			int idx = alterations.indices.size();
-			alterations.indices[string(alterationType)] = idx;
+		if (consumed == 0 && bufferLen == bufferSize) {
+			fprintf(stderr,
+					"\n< Error > File '%s' contains a word longer than %d characters.\n",
+					filename, bufferSize);
+			exit(0);
 		}
+		memmove(buffer, buffer + consumed, bufferLen - consumed);
+		bufferLen -= consumed;
 	}
+	delete[] buffer;
+	gzclose(fin);
 	samples.names = new string[samples.indices.size()];
 	genes.names = new string[genes.indices.size()];
 	for (auto it : samples.indices)
@@ -297,21 +354,6 @@ void readAlterationProfiles(const char * filename, int init_) {
 		for (auto it : alterations.indices)
 			alterations.names[it.second] = it.first;
 	}
-	rewind(fin);
-	geneAlterations = new unordered_map<int, unsigned int> [G.V];
-	while (fscanf(fin, "%s%s%s", sample, gene, alterationType) == 3) {
-		if (G.nodeIndices.find(string(gene)) == G.nodeIndices.end())
-			continue;
-		int geneIndex = G.nodeIndices[string(gene)];
-		int sampleIndex = samples.indices[sample];
-		int alterationIndex = alterations.indices[alterationType];
-		if (geneAlterations[geneIndex].find(sampleIndex)
-				== geneAlterations[geneIndex].end())
-			geneAlterations[geneIndex][sampleIndex] = 0;
-		int bitMask = (1 << alterationIndex);
-		geneAlterations[geneIndex][sampleIndex] |= bitMask;
-	}
-	fclose(fin);
 	fprintf(stderr, "done. (%.2lf seconds)\n",
 			double(clock() - timerStart) / CLOCKS_PER_SEC);
 	fprintf(stderr,